@@ -0,0 +1,96 @@
+require 'btle_scanner/series'
+
+module BtleScanner
+  # Decodes the manufacturer data sent by the sensor firmware (after the company id),
+  # see sensor-firmware/lib/payload/payload.h for the format
+  module Payload
+    VERSION = 1
+    VERSION_MARKER = 0x80
+
+    TEMPERATURE = 0x01
+    HUMIDITY    = 0x02
+    PRESSURE    = 0x04
+    SEQUENCE    = 0x08
+    BATTERY     = 0x10
+    STATUS      = 0x20
+    BATCH       = 0x40
+    PERIOD      = 0x80
+
+    STATUS_COLD_BOOT = 0x01
+
+    # in bit order of the flags, with the range a batch may carry
+    FIELDS = [
+      [:temperature, TEMPERATURE, 's<', -0x8000..0x7FFF],
+      [:humidity,    HUMIDITY,    'S<', 0..0xFFFF],
+      [:pressure,    PRESSURE,    'S<', 0..0xFFFF],
+      [:sequence,    SEQUENCE,    'S<', 0..0xFFFF],
+      [:battery,     BATTERY,     'S<', 0..0xFFFF],
+      [:status,      STATUS,      'C',  0..0xFF],
+      [:period,      PERIOD,      'S<', 0..0xFFFF]
+    ].freeze
+    # anything else in the flags byte is rejected
+    KNOWN_FIELDS = FIELDS.sum { |_, flag, _, _| flag }
+    LEGACY_FIELDS = TEMPERATURE | HUMIDITY
+
+    class << self
+      # returns a hash of the fields present in the payload, raises on malformed data and batches
+      def decode(data)
+        records = decode_records(data)
+        raise ArgumentError, 'Unexpected batch payload' if records.size != 1 || records.first[:flags] & BATCH != 0
+
+        records.first
+      end
+
+      # returns a hash like decode for every reading in the payload, which is either a batch or a single reading
+      def decode_records(data)
+        bytes = data.bytes
+        raise ArgumentError, 'Empty payload' if bytes.empty?
+
+        if bytes[0] & VERSION_MARKER == 0
+          # legacy firmware: flags byte, temperature and humidity
+          raise ArgumentError, 'Unknown legacy flags' if bytes[0] & ~LEGACY_FIELDS != 0
+
+          version = 0
+          flags = LEGACY_FIELDS
+          offset = 1
+        else
+          version = bytes[0] & ~VERSION_MARKER
+          raise ArgumentError, "Unsupported payload version #{version}" unless version == VERSION
+          raise ArgumentError, 'Truncated payload' if bytes.size < 2
+
+          flags = bytes[1]
+          raise ArgumentError, 'Unknown flags' if flags & ~(KNOWN_FIELDS | BATCH) != 0
+
+          offset = 2
+        end
+
+        fields = FIELDS.select { |_, flag, _, _| flags & flag != 0 }
+        return decode_batch(bytes, version, flags, fields) if flags & BATCH != 0
+
+        values = data.byteslice(offset..-1).unpack(fields.map { |_, _, directive, _| directive }.join)
+        raise ArgumentError, 'Truncated payload' if values.include?(nil)
+
+        [{ version: version, flags: flags }.merge(fields.map(&:first).zip(values).to_h)]
+      end
+
+      private
+
+      # every field is a series over all readings, see Series
+      def decode_batch(bytes, version, flags, fields)
+        raise ArgumentError, 'Truncated payload' if bytes.size < 3
+
+        count = bytes[2]
+        offset = 3
+        records = Array.new(count) { { version: version, flags: flags } }
+        fields.each do |name, _, _, range|
+          values, offset = Series.decode(bytes, offset, count)
+          raise ArgumentError, "#{name} out of range" unless values.all? { |v| range.cover?(v) }
+
+          records.zip(values) { |record, value| record[name] = value }
+        end
+
+        records
+      end
+    end
+  end
+end
@@ -1,40 +1,161 @@
 require 'set'
 
+require 'btle_scanner/payload'
 require 'btle_scanner/scanner'
 
 module BtleScanner
   # Waits for sensor updates from configured devices
   # and makes their data available
   class SensorReadingService
+    # sequence numbers remembered per sensor, batches repeat their readings across several frames
+    SEEN_SEQUENCES = 64
+    # when the sensor reports its period, sequence numbers are forgotten after as many periods
+    SEEN_PERIODS = SEEN_SEQUENCES
+    # seconds the frames of one batch are heard for, longer than the firmware's advertising window
+    # (ADVERTISE_TIME_SECONDS, or a second per frame) and shorter than its shortest period
+    BATCH_WINDOW = 30
+
     def initialize(sensors)
       @sensors = sensors.dup
     end
 
+    # yields the mac, the readings by kind and details about the transmission
+    # (sequence number, number of readings given up as lost since the previous one and the period
+    # until the next reading, if known),
+    # once for every reading of a batch. Readings older than the newest one
+    # seen are marked as historical, they are not the sensor's current state.
     def each_reading
       Scanner.each_advertisement do |mac, elements, rssi|
         sensor = @sensors[mac]
 
         next unless sensor
 
-        duplicate_time = sensor.fetch('duplicate_time')
-        next if (sensor['last_reading'] || 0) > (Time.now - duplicate_time).to_i
-        sensor['last_reading'] = Time.now.to_i
-
         own_data = elements.find { |e| e[:type] == 0xff }&.fetch(:data)
         unless own_data
           raise 'Expected manufacturer data to be present ' \
                 "(Advertisement from #{mac})"
         end
 
-        own_data = own_data[2..-1] # strip company id
+        begin
+          records = Payload.decode_records(own_data[2..-1]) # strip company id
+        rescue ArgumentError => e
+          # one unreadable advertisement, e.g. from newer firmware, must not stop the scan
+          warn "Skipping advertisement from #{mac}: #{e.message}"
+          next
+        end
+
+        records.each do |payload|
+          next if duplicate?(sensor, payload)
 
-        # TODO: use flags to determine available fields
-        flags, temperature, humidity = own_data.unpack('CS<S<')
-        yield(mac, {
-          temperature: temperature / 100.0,
-          humidity:    humidity / 100.0
-        })
+          yield(mac, readings(payload), transmission(sensor, payload))
+        end
       end
     end
+
+    private
+
+    def duplicate?(sensor, payload)
+      if payload[:sequence]
+        seen = sensor['seen_sequences'] ||= {}
+        expire_sequences(seen, payload[:period])
+        return true if seen.key?(payload[:sequence])
+
+        # a restarted sensor counts from 1 again, a reboot within SEEN_SEQUENCES readings drops its first readings
+        seen.clear if cold_boot?(payload)
+        seen.shift if seen.size >= SEEN_SEQUENCES
+        seen[payload[:sequence]] = Time.now.to_i
+      else
+        # legacy firmware repeats its readings without a sequence number
+        duplicate_time = sensor.fetch('duplicate_time')
+        return true if (sensor['last_reading'] || 0) > (Time.now - duplicate_time).to_i
+      end
+
+      sensor['last_reading'] = Time.now.to_i
+      false
+    end
+
+    # A batch sends its frames oldest first and repeats them, so a frame with
+    # older readings can be heard after a newer one. Those readings are behind
+    # the highest sequence number seen (modulo 2^16).
+    def historical?(sensor, payload)
+      last_sequence = sensor['last_sequence']
+      return false if last_sequence.nil? || cold_boot?(payload)
+
+      ahead = (payload[:sequence] - last_sequence) & 0xFFFF
+      ahead.zero? || ahead >= 0x8000
+    end
+
+    # an adaptive period can stretch SEEN_SEQUENCES readings over days, which is
+    # longer than a sensor takes to come back from an unnoticed restart
+    def expire_sequences(seen, period)
+      return unless period&.positive?
+
+      oldest = Time.now.to_i - SEEN_PERIODS * period
+      seen.shift while seen.any? && seen.first.last < oldest
+    end
+
+    def readings(payload)
+      readings = {}
+      readings[:temperature] = payload[:temperature] / 100.0 if payload[:temperature]
+      readings[:humidity] = payload[:humidity] / 100.0 if payload[:humidity]
+      readings[:pressure] = payload[:pressure] / 10.0 if payload[:pressure]
+      readings
+    end
+
+    def transmission(sensor, payload)
+      sequence = payload[:sequence]
+      return {} unless sequence
+
+      details = { sequence: sequence }
+      details[:period] = payload[:period] if payload[:period]
+      missing = sensor['missing_sequences'] ||= {}
+
+      if historical?(sensor, payload)
+        # fills a gap left by a newer frame, or was forgotten by duplicate?
+        missing.delete(sequence)
+        return details.merge(historical: true)
+      end
+
+      last_sequence = sensor['last_sequence']
+      sensor['last_sequence'] = sequence
+      return details if last_sequence.nil?
+
+      lost = settle_missing(missing)
+      if cold_boot?(payload)
+        lost += missing.size
+        missing.clear
+      else
+        lost += remember_missing(missing, last_sequence, sequence)
+      end
+      details.merge(lost_readings: lost)
+    end
+
+    # The sequence numbers skipped by a newer reading may still arrive in a
+    # later frame of the same batch. They count as lost once a reading of a
+    # later batch moves forward.
+    def settle_missing(missing)
+      oldest = Time.now.to_i - BATCH_WINDOW
+      settled = missing.count { |_, noticed| noticed < oldest }
+      missing.delete_if { |_, noticed| noticed < oldest }
+      settled
+    end
+
+    # returns how many skipped readings are lost right away, as more than SEEN_SEQUENCES are not remembered
+    def remember_missing(missing, last_sequence, sequence)
+      skipped = (sequence - last_sequence - 1) & 0xFFFF
+      remembered = [skipped, SEEN_SEQUENCES].min
+      remembered.downto(1) { |behind| missing[(sequence - behind) & 0xFFFF] = Time.now.to_i }
+
+      lost = skipped - remembered
+      while missing.size > SEEN_SEQUENCES
+        missing.shift
+        lost += 1
+      end
+      lost
+    end
+
+    def cold_boot?(payload)
+      (payload[:status] || 0) & Payload::STATUS_COLD_BOOT != 0
+    end
   end
 end
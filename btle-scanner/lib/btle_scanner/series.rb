@@ -0,0 +1,44 @@
+module BtleScanner
+  # Decodes delta encoded series of integers,
+  # see sensor-firmware/lib/series/series.h for the format
+  module Series
+    MAX_VARINT_SIZE = 5
+
+    class << self
+      # reads count values from bytes at offset, returns them and the offset behind them
+      def decode(bytes, offset, count)
+        previous = 0
+        values = Array.new(count) do
+          entry, offset = read_varint(bytes, offset)
+          previous = to_int32(previous + unzigzag(entry))
+        end
+
+        [values, offset]
+      end
+
+      private
+
+      def read_varint(bytes, offset)
+        value = 0
+        MAX_VARINT_SIZE.times do |i|
+          byte = bytes[offset + i]
+          raise ArgumentError, 'Truncated series' unless byte
+
+          value |= (byte & 0x7F) << (7 * i)
+          return [value, offset + i + 1] if byte & 0x80 == 0
+        end
+
+        raise ArgumentError, 'Malformed series'
+      end
+
+      def unzigzag(value)
+        (value >> 1) ^ -(value & 1)
+      end
+
+      # deltas wrap around at 32 bits
+      def to_int32(value)
+        ((value + 2**31) % 2**32) - 2**31
+      end
+    end
+  end
+end
@@ -54,6 +54,14 @@
 #define OVERSAMPLING_SETTINGS		UINT8_C(0x07)
 /* To identify filter and standby settings selected by user */
 #define FILTER_STANDBY_SETTINGS		UINT8_C(0x18)
+/* Samples per block of bme280_compensate_batch, t_fine is kept on the stack for one block */
+#define BME280_BATCH_BLOCK_LEN		64
+/* restrict is C99, the simulator examples build this file as C++ */
+#ifdef __cplusplus
+#define BME280_RESTRICT			__restrict__
+#else
+#define BME280_RESTRICT			restrict
+#endif
 
 /*!
  * @brief This internal API puts the device to sleep mode.
@@ -130,88 +138,190 @@ static void parse_temp_press_calib_data(const uint8_t *reg_data, struct bme280_d
 static void parse_humidity_calib_data(const uint8_t *reg_data, struct bme280_dev *dev);
 
 #ifdef BME280_FLOAT_ENABLE
+/*!
+ * @brief This internal API is used to compensate the raw temperature data and
+ * return the compensated temperature data in double data type. Inline, so that the
+ * batch kernels run the same code as bme280_compensate_data.
+ *
+ * @param[in] uncomp_temperature : Contains the uncompensated temperature data.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ * @param[out] t_fine : Fine temperature for the other channels.
+ *
+ * @return Compensated temperature data.
+ * @retval Compensated temperature data in double.
+ */
+static inline double compensate_temperature(uint32_t uncomp_temperature, const struct bme280_calib_coeffs *coeffs,
+					int32_t *t_fine);
+
 /*!
  * @brief This internal API is used to compensate the raw pressure data and
  * return the compensated pressure data in double data type.
  *
- * @param[in] uncomp_data : Contains the uncompensated pressure data.
- * @param[in] calib_data : Pointer to the calibration data structure.
+ * @param[in] uncomp_pressure : Contains the uncompensated pressure data.
+ * @param[in] t_fine : Fine temperature of the same measurement.
+ * @param[in] coeffs : Pointer to the derived coefficients.
  *
  * @return Compensated pressure data.
  * @retval Compensated pressure data in double.
  */
-static double compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data);
+static inline double compensate_pressure(uint32_t uncomp_pressure, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs);
 
 /*!
  * @brief This internal API is used to compensate the raw humidity data and
  * return the compensated humidity data in double data type.
  *
- * @param[in] uncomp_data : Contains the uncompensated humidity data.
- * @param[in] calib_data : Pointer to the calibration data structure.
+ * @param[in] uncomp_humidity : Contains the uncompensated humidity data.
+ * @param[in] t_fine : Fine temperature of the same measurement.
+ * @param[in] coeffs : Pointer to the derived coefficients.
  *
  * @return Compensated humidity data.
  * @retval Compensated humidity data in double.
  */
-static double compensate_humidity(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data);
+static inline double compensate_humidity(uint32_t uncomp_humidity, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs);
 
 /*!
- * @brief This internal API is used to compensate the raw temperature data and
- * return the compensated temperature data in double data type.
+ * @brief This internal API compensates a block of raw temperature values in
+ * double data type and stores t_fine of each sample for the other channels.
  *
- * @param[in] uncomp_data : Contains the uncompensated temperature data.
- * @param[in] calib_data : Pointer to calibration data structure.
+ * @param[in] temp : Raw temperature values.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated temperature values.
+ * @param[out] t_fine : Fine temperature of each sample.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ */
+static void compensate_temperature_batch(const uint32_t *temp, size_t len, double *comp, int32_t *t_fine,
+					 const struct bme280_calib_coeffs *coeffs);
+
+/*!
+ * @brief This internal API compensates a block of raw pressure values in
+ * double data type.
  *
- * @return Compensated temperature data.
- * @retval Compensated temperature data in double.
+ * @param[in] press : Raw pressure values.
+ * @param[in] t_fine : Fine temperature of each sample.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated pressure values.
+ * @param[in] coeffs : Pointer to the derived coefficients.
  */
-static  double compensate_temperature(const struct bme280_uncomp_data *uncomp_data,
-						struct bme280_calib_data *calib_data);
+static void compensate_pressure_batch(const uint32_t *press, const int32_t *t_fine, size_t len, double *comp,
+				      const struct bme280_calib_coeffs *coeffs);
+
+/*!
+ * @brief This internal API compensates a block of raw humidity values in
+ * double data type.
+ *
+ * @param[in] hum : Raw humidity values.
+ * @param[in] t_fine : Fine temperature of each sample.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated humidity values.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ */
+static void compensate_humidity_batch(const uint16_t *hum, const int32_t *t_fine, size_t len, double *comp,
+				      const struct bme280_calib_coeffs *coeffs);
 
 #else
 
 /*!
  * @brief This internal API is used to compensate the raw temperature data and
- * return the compensated temperature data in integer data type.
+ * return the compensated temperature data in integer data type. Inline, so that the
+ * batch kernels run the same code as bme280_compensate_data.
  *
- * @param[in] uncomp_data : Contains the uncompensated temperature data.
- * @param[in] calib_data : Pointer to calibration data structure.
+ * @param[in] uncomp_temperature : Contains the uncompensated temperature data.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ * @param[out] t_fine : Fine temperature for the other channels.
  *
  * @return Compensated temperature data.
  * @retval Compensated temperature data in integer.
  */
-static int32_t compensate_temperature(const struct bme280_uncomp_data *uncomp_data,
-						struct bme280_calib_data *calib_data);
+static inline int32_t compensate_temperature(uint32_t uncomp_temperature, const struct bme280_calib_coeffs *coeffs,
+					int32_t *t_fine);
 
 /*!
  * @brief This internal API is used to compensate the raw pressure data and
  * return the compensated pressure data in integer data type.
  *
- * @param[in] uncomp_data : Contains the uncompensated pressure data.
- * @param[in] calib_data : Pointer to the calibration data structure.
+ * @param[in] uncomp_pressure : Contains the uncompensated pressure data.
+ * @param[in] t_fine : Fine temperature of the same measurement.
+ * @param[in] coeffs : Pointer to the derived coefficients.
  *
  * @return Compensated pressure data.
  * @retval Compensated pressure data in integer.
  */
-static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data);
+static inline uint32_t compensate_pressure(uint32_t uncomp_pressure, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs);
 
 /*!
  * @brief This internal API is used to compensate the raw humidity data and
  * return the compensated humidity data in integer data type.
  *
- * @param[in] uncomp_data : Contains the uncompensated humidity data.
- * @param[in] calib_data : Pointer to the calibration data structure.
+ * @param[in] uncomp_humidity : Contains the uncompensated humidity data.
+ * @param[in] t_fine : Fine temperature of the same measurement.
+ * @param[in] coeffs : Pointer to the derived coefficients.
  *
  * @return Compensated humidity data.
  * @retval Compensated humidity data in integer.
  */
-static uint32_t compensate_humidity(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data);
+static inline uint32_t compensate_humidity(uint32_t uncomp_humidity, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs);
+
+/*!
+ * @brief This internal API compensates a block of raw temperature values in
+ * integer data type and stores t_fine of each sample for the other channels.
+ *
+ * @param[in] temp : Raw temperature values.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated temperature values.
+ * @param[out] t_fine : Fine temperature of each sample.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ */
+static void compensate_temperature_batch(const uint32_t *temp, size_t len, int32_t *comp, int32_t *t_fine,
+					 const struct bme280_calib_coeffs *coeffs);
+
+/*!
+ * @brief This internal API compensates a block of raw pressure values in
+ * integer data type.
+ *
+ * @param[in] press : Raw pressure values.
+ * @param[in] t_fine : Fine temperature of each sample.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated pressure values.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ */
+static void compensate_pressure_batch(const uint32_t *press, const int32_t *t_fine, size_t len, uint32_t *comp,
+				      const struct bme280_calib_coeffs *coeffs);
+
+/*!
+ * @brief This internal API compensates a block of raw humidity values in
+ * integer data type.
+ *
+ * @param[in] hum : Raw humidity values.
+ * @param[in] t_fine : Fine temperature of each sample.
+ * @param[in] len : Number of samples.
+ * @param[out] comp : Compensated humidity values.
+ * @param[in] coeffs : Pointer to the derived coefficients.
+ */
+static void compensate_humidity_batch(const uint16_t *hum, const int32_t *t_fine, size_t len, uint32_t *comp,
+				      const struct bme280_calib_coeffs *coeffs);
 
 #endif
 
+/*!
+ * @brief This internal API derives the temperature and pressure coefficients
+ * of calib_data->coeffs from the trim values.
+ *
+ * @param[in,out] calib_data : Pointer to calibration data structure.
+ */
+static void derive_temp_press_coeffs(struct bme280_calib_data *calib_data);
+
+/*!
+ * @brief This internal API derives the humidity coefficients of
+ * calib_data->coeffs from the trim values.
+ *
+ * @param[in,out] calib_data : Pointer to calibration data structure.
+ */
+static void derive_humidity_coeffs(struct bme280_calib_data *calib_data);
+
 /*!
  * @brief This internal API is used to identify the settings which the user
  * wants to modify in the sensor.
@@ -329,6 +439,16 @@ static void fill_standby_settings(uint8_t *reg_data, const struct bme280_setting
  */
 static void parse_device_settings(const uint8_t *reg_data, struct bme280_settings *settings);
 
+/*!
+ * @brief This internal API converts an oversampling setting into the number
+ * of samples taken during a measurement.
+ *
+ * @param[in] osr : Oversampling setting, e.g. BME280_OVERSAMPLING_4X.
+ *
+ * @return Number of samples, zero if the measurement is skipped.
+ */
+static uint32_t osr_to_samples(uint8_t osr);
+
 /*!
  * @brief This internal API reloads the already existing device settings in the
  * sensor after soft reset.
@@ -342,6 +462,15 @@ static void parse_device_settings(const uint8_t *reg_data, struct bme280_setting
  */
 static int8_t reload_device_settings(const struct bme280_settings *settings, const struct bme280_dev *dev);
 
+/*!
+ * @brief This internal API waits for the given number of microseconds, with
+ * delay_us if it is set and with delay_ms rounded up otherwise.
+ *
+ * @param[in] period : Time to wait in microseconds.
+ * @param[in] dev : Structure instance of bme280_dev.
+ */
+static void delay_us(uint32_t period, const struct bme280_dev *dev);
+
 /****************** Global Function Definitions *******************************/
 
 /*!
@@ -591,13 +720,17 @@ int8_t bme280_get_sensor_data(uint8_t sensor_comp, struct bme280_data *comp_data
 	the sensor */
 	uint8_t reg_data[BME280_P_T_H_DATA_LEN] = {0};
 	struct bme280_uncomp_data uncomp_data = {0};
+	/* Burst read from the first to the last selected channel, temperature is
+	   always needed for t_fine */
+	uint8_t first = (sensor_comp & BME280_PRESS) ? 0 : BME280_TEMP_DATA_OFFSET;
+	uint8_t last = (sensor_comp & BME280_HUM) ? BME280_P_T_H_DATA_LEN : BME280_HUM_DATA_OFFSET;
 
 	/* Check for null pointer in the device structure*/
 	rslt = null_ptr_check(dev);
 
 	if ((rslt == BME280_OK) && (comp_data != NULL)) {
-		/* Read the pressure and temperature data from the sensor */
-		rslt = bme280_get_regs(BME280_DATA_ADDR, reg_data, BME280_P_T_H_DATA_LEN, dev);
+		/* Read the selected data from the sensor */
+		rslt = bme280_get_regs(BME280_DATA_ADDR + first, &reg_data[first], last - first, dev);
 
 		if (rslt == BME280_OK) {
 			/* Parse the read data from the sensor */
@@ -658,18 +791,24 @@ int8_t bme280_compensate_data(uint8_t sensor_comp, const struct bme280_uncomp_da
 		comp_data->temperature = 0;
 		comp_data->pressure = 0;
 		comp_data->humidity = 0;
+		/* Calibration data filled in by hand has no coefficients yet */
+		if (!calib_data->coeffs.valid)
+			bme280_derive_calib_coeffs(calib_data);
 		/* If pressure or temperature component is selected */
 		if (sensor_comp & (BME280_PRESS | BME280_TEMP | BME280_HUM)) {
 			/* Compensate the temperature data */
-			comp_data->temperature = compensate_temperature(uncomp_data, calib_data);
+			comp_data->temperature = compensate_temperature(uncomp_data->temperature, &calib_data->coeffs,
+									&calib_data->t_fine);
 		}
 		if (sensor_comp & BME280_PRESS) {
 			/* Compensate the pressure data */
-			comp_data->pressure = compensate_pressure(uncomp_data, calib_data);
+			comp_data->pressure = compensate_pressure(uncomp_data->pressure, calib_data->t_fine,
+								  &calib_data->coeffs);
 		}
 		if (sensor_comp & BME280_HUM) {
 			/* Compensate the humidity data */
-			comp_data->humidity = compensate_humidity(uncomp_data, calib_data);
+			comp_data->humidity = compensate_humidity(uncomp_data->humidity, calib_data->t_fine,
+								  &calib_data->coeffs);
 		}
 	} else {
 		rslt = BME280_E_NULL_PTR;
@@ -678,6 +817,197 @@ int8_t bme280_compensate_data(uint8_t sensor_comp, const struct bme280_uncomp_da
 	return rslt;
 }
 
+/*!
+ * @brief This API compensates many raw samples at once, one array per
+ * channel, with the same results as bme280_compensate_data.
+ */
+int8_t bme280_compensate_batch(const uint32_t *press, const uint32_t *temp, const uint16_t *hum, size_t n,
+			       const struct bme280_batch_data *comp_data, const struct bme280_calib_data *calib_data)
+{
+	int8_t rslt = BME280_OK;
+	/* Copy of the calibration data, derived once for all samples */
+	struct bme280_calib_data calib;
+	/* t_fine and, if not wanted, the temperature of the current block */
+	int32_t t_fine[BME280_BATCH_BLOCK_LEN];
+#ifdef BME280_FLOAT_ENABLE
+	double temperature[BME280_BATCH_BLOCK_LEN];
+#else
+	int32_t temperature[BME280_BATCH_BLOCK_LEN];
+#endif
+	size_t start;
+	size_t len;
+
+	if ((temp != NULL) && (comp_data != NULL) && (calib_data != NULL)) {
+		calib = *calib_data;
+		if (!calib.coeffs.valid)
+			bme280_derive_calib_coeffs(&calib);
+
+		for (start = 0; start < n; start += len) {
+			len = n - start < BME280_BATCH_BLOCK_LEN ? n - start : BME280_BATCH_BLOCK_LEN;
+
+			compensate_temperature_batch(temp + start, len,
+						     comp_data->temperature ? comp_data->temperature + start : temperature,
+						     t_fine, &calib.coeffs);
+			if ((press != NULL) && (comp_data->pressure != NULL))
+				compensate_pressure_batch(press + start, t_fine, len, comp_data->pressure + start,
+							  &calib.coeffs);
+			if ((hum != NULL) && (comp_data->humidity != NULL))
+				compensate_humidity_batch(hum + start, t_fine, len, comp_data->humidity + start,
+							  &calib.coeffs);
+		}
+	} else {
+		rslt = BME280_E_NULL_PTR;
+	}
+
+	return rslt;
+}
+
+/*!
+ * @brief This API calculates the typical and maximum time a measurement
+ * takes with the given oversampling settings.
+ */
+void bme280_calc_measurement_time(const struct bme280_settings *settings, uint32_t *typ_us, uint32_t *max_us)
+{
+	uint32_t osr_t = osr_to_samples(settings->osr_t);
+	uint32_t osr_p = osr_to_samples(settings->osr_p);
+	uint32_t osr_h = osr_to_samples(settings->osr_h);
+
+	/* t_typ = 1 + [2 * T_osr] + [2 * P_osr + 0.5] + [2 * H_osr + 0.5] ms */
+	*typ_us = 1000 + 2000 * osr_t;
+	/* t_max = 1.25 + [2.3 * T_osr] + [2.3 * P_osr + 0.575] + [2.3 * H_osr + 0.575] ms */
+	*max_us = 1250 + 2300 * osr_t;
+	/* Skipped measurements do not contribute their fixed overhead */
+	if (osr_p) {
+		*typ_us += 2000 * osr_p + 500;
+		*max_us += 2300 * osr_p + 575;
+	}
+	if (osr_h) {
+		*typ_us += 2000 * osr_h + 500;
+		*max_us += 2300 * osr_h + 575;
+	}
+}
+
+/*!
+ * @brief This API starts a measurement in forced mode and returns
+ * immediately.
+ */
+int8_t bme280_trigger_measurement(struct bme280_dev *dev)
+{
+	int8_t rslt;
+	uint8_t reg_addr[2] = {BME280_CTRL_HUM_ADDR, BME280_CTRL_MEAS_ADDR};
+	uint8_t reg_data[2];
+
+	/* Check for null pointer in the device structure*/
+	rslt = null_ptr_check(dev);
+	if (rslt == BME280_OK) {
+		reg_data[0] = dev->settings.osr_h & BME280_CTRL_HUM_MSK;
+		reg_data[1] = BME280_SET_BITS(0, BME280_CTRL_TEMP, dev->settings.osr_t);
+		reg_data[1] = BME280_SET_BITS(reg_data[1], BME280_CTRL_PRESS, dev->settings.osr_p);
+		reg_data[1] = BME280_SET_BITS_POS_0(reg_data[1], BME280_SENSOR_MODE, BME280_FORCED_MODE);
+		rslt = bme280_set_regs(reg_addr, reg_data, 2, dev);
+		dev->meas_state = (rslt == BME280_OK) ? BME280_MEAS_PENDING : BME280_MEAS_IDLE;
+		if (dev->time_us != NULL)
+			dev->meas_start_us = dev->time_us();
+	}
+
+	return rslt;
+}
+
+/*!
+ * @brief This API checks whether the measurement started by
+ * bme280_trigger_measurement has completed.
+ */
+int8_t bme280_poll_measurement(uint8_t *ready, struct bme280_dev *dev)
+{
+	int8_t rslt;
+	/* status (0xF3) and ctrl_meas (0xF4) */
+	uint8_t reg_data[2];
+
+	/* Check for null pointer in the device structure*/
+	rslt = null_ptr_check(dev);
+	if ((rslt == BME280_OK) && (ready != NULL)) {
+		*ready = (dev->meas_state == BME280_MEAS_READY);
+		if (dev->meas_state == BME280_MEAS_IDLE) {
+			rslt = BME280_E_NO_MEASUREMENT;
+		} else if (dev->meas_state == BME280_MEAS_PENDING) {
+			/* The measuring bit alone is not enough, polling right after the
+			trigger may happen before the conversion has actually started */
+			rslt = bme280_get_regs(BME280_STATUS_ADDR, reg_data, 2, dev);
+			if ((rslt == BME280_OK) && !BME280_GET_BITS(reg_data[0], BME280_STATUS_MEAS) &&
+				(BME280_GET_BITS_POS_0(reg_data[1], BME280_SENSOR_MODE) == BME280_SLEEP_MODE)) {
+				dev->meas_state = BME280_MEAS_READY;
+				*ready = 1;
+			}
+		}
+	} else {
+		rslt = BME280_E_NULL_PTR;
+	}
+
+	return rslt;
+}
+
+/*!
+ * @brief This API reads and compensates the result of the measurement
+ * started by bme280_trigger_measurement.
+ */
+int8_t bme280_fetch_measurement(uint8_t sensor_comp, struct bme280_data *comp_data, struct bme280_dev *dev)
+{
+	int8_t rslt;
+	uint8_t ready;
+
+	rslt = bme280_poll_measurement(&ready, dev);
+	if ((rslt == BME280_OK) && !ready)
+		rslt = BME280_E_MEAS_NOT_READY;
+	if (rslt == BME280_OK) {
+		rslt = bme280_get_sensor_data(sensor_comp, comp_data, dev);
+		dev->meas_state = BME280_MEAS_IDLE;
+	}
+
+	return rslt;
+}
+
+/*!
+ * @brief This API waits until the measurement started by
+ * bme280_trigger_measurement has completed.
+ */
+int8_t bme280_wait_for_measurement(struct bme280_dev *dev)
+{
+	int8_t rslt;
+	uint32_t typ_us;
+	uint32_t max_us;
+	uint32_t elapsed_us = 0;
+	uint8_t ready;
+
+	/* Check for null pointer in the device structure*/
+	rslt = null_ptr_check(dev);
+	if (rslt == BME280_OK) {
+		bme280_calc_measurement_time(&dev->settings, &typ_us, &max_us);
+		/* Without a clock only the delays are counted, from this call */
+		if (dev->time_us != NULL)
+			elapsed_us = dev->time_us() - dev->meas_start_us;
+		/* No need to poll before the measurement can be done */
+		if (elapsed_us < typ_us) {
+			delay_us(typ_us - elapsed_us, dev);
+			elapsed_us = typ_us;
+		}
+		while (1) {
+			rslt = bme280_poll_measurement(&ready, dev);
+			if ((rslt != BME280_OK) || ready)
+				break;
+			if (dev->time_us != NULL)
+				elapsed_us = dev->time_us() - dev->meas_start_us;
+			if (elapsed_us >= max_us) {
+				rslt = BME280_E_MEAS_TIMEOUT;
+				break;
+			}
+			delay_us(1000, dev);
+			elapsed_us += 1000;
+		}
+	}
+
+	return rslt;
+}
+
 /*!
  * @brief This internal API sets the oversampling settings for pressure,
  * temperature and humidity in the sensor.
@@ -819,6 +1149,25 @@ static void parse_device_settings(const uint8_t *reg_data, struct bme280_setting
 	settings->filter = BME280_GET_BITS(reg_data[3], BME280_FILTER);
 	settings->standby_time = BME280_GET_BITS(reg_data[3], BME280_STANDBY);
 }
+
+/*!
+ * @brief This internal API converts an oversampling setting into the number
+ * of samples taken during a measurement.
+ */
+static uint32_t osr_to_samples(uint8_t osr)
+{
+	uint32_t samples;
+
+	if (osr == BME280_NO_OVERSAMPLING)
+		samples = 0;
+	else if (osr >= BME280_OVERSAMPLING_16X)
+		samples = 16;
+	else
+		samples = UINT32_C(1) << (osr - 1);
+
+	return samples;
+}
+
 /*!
  * @brief This internal API writes the power mode in the sensor.
  */
@@ -876,13 +1225,64 @@ static int8_t reload_device_settings(const struct bme280_settings *settings, con
 	return rslt;
 }
 
+/*!
+ * @brief This API derives the compensation coefficients from the trim values.
+ */
+void bme280_derive_calib_coeffs(struct bme280_calib_data *calib_data)
+{
+	if (calib_data != NULL) {
+		derive_temp_press_coeffs(calib_data);
+		derive_humidity_coeffs(calib_data);
+		calib_data->coeffs.valid = 1;
+	}
+}
+
 #ifdef BME280_FLOAT_ENABLE
 /*!
- * @brief This internal API is used to compensate the raw temperature data and
- * return the compensated temperature data in double data type.
+ * @brief This internal API derives the temperature and pressure coefficients.
+ * The pressure ones carry the power of two divisions of compensate_pressure,
+ * which are exact in double.
+ */
+static void derive_temp_press_coeffs(struct bme280_calib_data *calib_data)
+{
+	struct bme280_calib_coeffs *coeffs = &calib_data->coeffs;
+
+	coeffs->t1_1024 = ((double)calib_data->dig_T1) / 1024.0;
+	coeffs->t1_8192 = ((double)calib_data->dig_T1) / 8192.0;
+	coeffs->t2 = (double)calib_data->dig_T2;
+	coeffs->t3 = (double)calib_data->dig_T3;
+	coeffs->p1 = (double)calib_data->dig_P1;
+	coeffs->p2 = ((double)calib_data->dig_P2) / 17179869184.0;
+	coeffs->p3 = ((double)calib_data->dig_P3) / 9007199254740992.0;
+	coeffs->p4 = ((double)calib_data->dig_P4) * 16.0;
+	coeffs->p5 = ((double)calib_data->dig_P5) / 8192.0;
+	coeffs->p6 = ((double)calib_data->dig_P6) / 536870912.0;
+	coeffs->p7 = ((double)calib_data->dig_P7) / 16.0;
+	coeffs->p8 = ((double)calib_data->dig_P8) / 524288.0;
+	coeffs->p9 = ((double)calib_data->dig_P9) / 34359738368.0;
+}
+
+/*!
+ * @brief This internal API derives the humidity coefficients.
  */
-static double compensate_temperature(const struct bme280_uncomp_data *uncomp_data,
-						struct bme280_calib_data *calib_data)
+static void derive_humidity_coeffs(struct bme280_calib_data *calib_data)
+{
+	struct bme280_calib_coeffs *coeffs = &calib_data->coeffs;
+
+	coeffs->h1 = ((double)calib_data->dig_H1) / 524288.0;
+	coeffs->h2 = ((double)calib_data->dig_H2) / 65536.0;
+	coeffs->h3 = ((double)calib_data->dig_H3) / 67108864.0;
+	coeffs->h4 = ((double)calib_data->dig_H4) * 64.0;
+	coeffs->h5 = ((double)calib_data->dig_H5) / 16384.0;
+	coeffs->h6 = ((double)calib_data->dig_H6) / 67108864.0;
+}
+
+/*!
+ * @brief This internal API compensates the raw temperature data with the
+ * derived coefficients.
+ */
+static inline double compensate_temperature(uint32_t uncomp_temperature, const struct bme280_calib_coeffs *coeffs,
+					int32_t *t_fine)
 {
 	double var1;
 	double var2;
@@ -890,54 +1290,45 @@ static double compensate_temperature(const struct bme280_uncomp_data *uncomp_dat
 	double temperature_min = -40;
 	double temperature_max = 85;
 
-	var1 = ((double)uncomp_data->temperature) / 16384.0 - ((double)calib_data->dig_T1) / 1024.0;
-	var1 = var1 * ((double)calib_data->dig_T2);
-	var2 = (((double)uncomp_data->temperature) / 131072.0 - ((double)calib_data->dig_T1) / 8192.0);
-	var2 = (var2 * var2) * ((double)calib_data->dig_T3);
-	calib_data->t_fine = (int32_t)(var1 + var2);
+	var1 = (((double)uncomp_temperature) / 16384.0 - coeffs->t1_1024) * coeffs->t2;
+	var2 = ((double)uncomp_temperature) / 131072.0 - coeffs->t1_8192;
+	var2 = (var2 * var2) * coeffs->t3;
+	*t_fine = (int32_t)(var1 + var2);
 	temperature = (var1 + var2) / 5120.0;
 
-	if (temperature < temperature_min)
-		temperature = temperature_min;
-	else if (temperature > temperature_max)
-		temperature = temperature_max;
+	/* Selects instead of branches, so that the batch loops vectorize */
+	temperature = temperature < temperature_min ? temperature_min : temperature;
+	temperature = temperature > temperature_max ? temperature_max : temperature;
 
 	return temperature;
 }
 
 /*!
- * @brief This internal API is used to compensate the raw pressure data and
- * return the compensated pressure data in double data type.
+ * @brief This internal API compensates the raw pressure data with the derived
+ * coefficients. var2 is scaled by 2^-14 and var1 by 2^-15 right away.
  */
-static double compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data)
+static inline double compensate_pressure(uint32_t uncomp_pressure, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs)
 {
 	double var1;
 	double var2;
-	double var3;
 	double pressure;
 	double pressure_min = 30000.0;
 	double pressure_max = 110000.0;
 
-	var1 = ((double)calib_data->t_fine / 2.0) - 64000.0;
-	var2 = var1 * var1 * ((double)calib_data->dig_P6) / 32768.0;
-	var2 = var2 + var1 * ((double)calib_data->dig_P5) * 2.0;
-	var2 = (var2 / 4.0) + (((double)calib_data->dig_P4) * 65536.0);
-	var3 = ((double)calib_data->dig_P3) * var1 * var1 / 524288.0;
-	var1 = (var3 + ((double)calib_data->dig_P2) * var1) / 524288.0;
-	var1 = (1.0 + var1 / 32768.0) * ((double)calib_data->dig_P1);
+	var1 = ((double)t_fine / 2.0) - 64000.0;
+	var2 = var1 * var1 * coeffs->p6 + var1 * coeffs->p5 + coeffs->p4;
+	var1 = (1.0 + (coeffs->p3 * var1 * var1 + coeffs->p2 * var1)) * coeffs->p1;
 	/* avoid exception caused by division by zero */
 	if (var1) {
-		pressure = 1048576.0 - (double) uncomp_data->pressure;
-		pressure = (pressure - (var2 / 4096.0)) * 6250.0 / var1;
-		var1 = ((double)calib_data->dig_P9) * pressure * pressure / 2147483648.0;
-		var2 = pressure * ((double)calib_data->dig_P8) / 32768.0;
-		pressure = pressure + (var1 + var2 + ((double)calib_data->dig_P7)) / 16.0;
-
-		if (pressure < pressure_min)
-			pressure = pressure_min;
-		else if (pressure > pressure_max)
-			pressure = pressure_max;
+		pressure = 1048576.0 - (double) uncomp_pressure;
+		pressure = (pressure - var2) * 6250.0 / var1;
+		var1 = coeffs->p9 * pressure * pressure;
+		var2 = pressure * coeffs->p8;
+		pressure = pressure + (var1 + var2 + coeffs->p7);
+
+		pressure = pressure < pressure_min ? pressure_min : pressure;
+		pressure = pressure > pressure_max ? pressure_max : pressure;
 	} else { /* Invalid case */
 		pressure = pressure_min;
 	}
@@ -946,46 +1337,89 @@ static double compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
 }
 
 /*!
- * @brief This internal API is used to compensate the raw humidity data and
- * return the compensated humidity data in double data type.
+ * @brief This internal API compensates the raw humidity data with the derived
+ * coefficients.
  */
-static double compensate_humidity(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data)
+static inline double compensate_humidity(uint32_t uncomp_humidity, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs)
 {
 	double humidity;
 	double humidity_min = 0.0;
 	double humidity_max = 100.0;
 	double var1;
-	double var2;
-	double var3;
-	double var4;
 	double var5;
 	double var6;
 
-	var1 = ((double)calib_data->t_fine) - 76800.0;
-	var2 = (((double)calib_data->dig_H4) * 64.0 + (((double)calib_data->dig_H5) / 16384.0) * var1);
-	var3 = uncomp_data->humidity - var2;
-	var4 = ((double)calib_data->dig_H2) / 65536.0;
-	var5 = (1.0 + (((double)calib_data->dig_H3) / 67108864.0) * var1);
-	var6 = 1.0 + (((double)calib_data->dig_H6) / 67108864.0) * var1 * var5;
-	var6 = var3 * var4 * (var5 * var6);
-	humidity = var6 * (1.0 - ((double)calib_data->dig_H1) * var6 / 524288.0);
+	var1 = ((double)t_fine) - 76800.0;
+	var5 = 1.0 + coeffs->h3 * var1;
+	var6 = 1.0 + coeffs->h6 * var1 * var5;
+	var6 = (uncomp_humidity - (coeffs->h4 + coeffs->h5 * var1)) * coeffs->h2 * (var5 * var6);
+	humidity = var6 * (1.0 - coeffs->h1 * var6);
 
-	if (humidity > humidity_max)
-		humidity = humidity_max;
-	else if (humidity < humidity_min)
-		humidity = humidity_min;
+	humidity = humidity > humidity_max ? humidity_max : humidity;
+	humidity = humidity < humidity_min ? humidity_min : humidity;
 
 	return humidity;
 }
+#else
+/*!
+ * @brief This internal API derives the temperature and pressure coefficients.
+ * The trim values are converted and multiplied by their constant factors
+ * once, the multiplications by powers of two give the same values as in
+ * compensate_pressure.
+ */
+static void derive_temp_press_coeffs(struct bme280_calib_data *calib_data)
+{
+	struct bme280_calib_coeffs *coeffs = &calib_data->coeffs;
 
+	coeffs->t1 = (int32_t)calib_data->dig_T1;
+	coeffs->t1x2 = (int32_t)calib_data->dig_T1 * 2;
+	coeffs->t2 = (int32_t)calib_data->dig_T2;
+	coeffs->t3 = (int32_t)calib_data->dig_T3;
+#ifdef BME280_64BIT_ENABLE
+	coeffs->p1 = (int64_t)calib_data->dig_P1;
+	coeffs->p2 = ((int64_t)calib_data->dig_P2) * 4096;
+	coeffs->p3 = (int64_t)calib_data->dig_P3;
+	coeffs->p4 = ((int64_t)calib_data->dig_P4) * 34359738368;
+	coeffs->p5 = ((int64_t)calib_data->dig_P5) * 131072;
+	coeffs->p6 = (int64_t)calib_data->dig_P6;
+	coeffs->p7 = ((int64_t)calib_data->dig_P7) * 16;
+	coeffs->p8 = (int64_t)calib_data->dig_P8;
+	coeffs->p9 = (int64_t)calib_data->dig_P9;
 #else
+	coeffs->p1 = (int32_t)calib_data->dig_P1;
+	coeffs->p2 = (int32_t)calib_data->dig_P2;
+	coeffs->p3 = (int32_t)calib_data->dig_P3;
+	coeffs->p4 = ((int32_t)calib_data->dig_P4) * 65536;
+	coeffs->p5 = ((int32_t)calib_data->dig_P5) * 2;
+	coeffs->p6 = (int32_t)calib_data->dig_P6;
+	coeffs->p7 = (int32_t)calib_data->dig_P7;
+	coeffs->p8 = (int32_t)calib_data->dig_P8;
+	coeffs->p9 = (int32_t)calib_data->dig_P9;
+#endif
+}
+
 /*!
- * @brief This internal API is used to compensate the raw temperature data and
- * return the compensated temperature data in integer data type.
+ * @brief This internal API derives the humidity coefficients.
+ */
+static void derive_humidity_coeffs(struct bme280_calib_data *calib_data)
+{
+	struct bme280_calib_coeffs *coeffs = &calib_data->coeffs;
+
+	coeffs->h1 = (int32_t)calib_data->dig_H1;
+	coeffs->h2 = (int32_t)calib_data->dig_H2;
+	coeffs->h3 = (int32_t)calib_data->dig_H3;
+	coeffs->h4 = (int32_t)(((int32_t)calib_data->dig_H4) * 1048576);
+	coeffs->h5 = (int32_t)calib_data->dig_H5;
+	coeffs->h6 = (int32_t)calib_data->dig_H6;
+}
+
+/*!
+ * @brief This internal API compensates the raw temperature data with the
+ * derived coefficients.
  */
-static int32_t compensate_temperature(const struct bme280_uncomp_data *uncomp_data,
-						struct bme280_calib_data *calib_data)
+static inline int32_t compensate_temperature(uint32_t uncomp_temperature, const struct bme280_calib_coeffs *coeffs,
+					int32_t *t_fine)
 {
 	int32_t var1;
 	int32_t var2;
@@ -993,58 +1427,51 @@ static int32_t compensate_temperature(const struct bme280_uncomp_data *uncomp_da
 	int32_t temperature_min = -4000;
 	int32_t temperature_max = 8500;
 
-	var1 = (int32_t)((uncomp_data->temperature / 8) - ((int32_t)calib_data->dig_T1 * 2));
-	var1 = (var1 * ((int32_t)calib_data->dig_T2)) / 2048;
-	var2 = (int32_t)((uncomp_data->temperature / 16) - ((int32_t)calib_data->dig_T1));
-	var2 = (((var2 * var2) / 4096) * ((int32_t)calib_data->dig_T3)) / 16384;
-	calib_data->t_fine = var1 + var2;
-	temperature = (calib_data->t_fine * 5 + 128) / 256;
+	var1 = (int32_t)((uncomp_temperature / 8) - coeffs->t1x2);
+	var1 = (var1 * coeffs->t2) / 2048;
+	var2 = (int32_t)((uncomp_temperature / 16) - coeffs->t1);
+	var2 = (((var2 * var2) / 4096) * coeffs->t3) / 16384;
+	*t_fine = var1 + var2;
+	temperature = ((var1 + var2) * 5 + 128) / 256;
 
-	if (temperature < temperature_min)
-		temperature = temperature_min;
-	else if (temperature > temperature_max)
-		temperature = temperature_max;
+	/* Selects instead of branches, so that the batch loops vectorize */
+	temperature = temperature < temperature_min ? temperature_min : temperature;
+	temperature = temperature > temperature_max ? temperature_max : temperature;
 
 	return temperature;
 }
+
 #ifdef BME280_64BIT_ENABLE
 /*!
- * @brief This internal API is used to compensate the raw pressure data and
- * return the compensated pressure data in integer data type with higher
- * accuracy.
+ * @brief This internal API compensates the raw pressure data with the derived
+ * coefficients.
  */
-static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data)
+static inline uint32_t compensate_pressure(uint32_t uncomp_pressure, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs)
 {
 	int64_t var1;
 	int64_t var2;
-	int64_t var3;
 	int64_t var4;
 	uint32_t pressure;
 	uint32_t pressure_min = 3000000;
 	uint32_t pressure_max = 11000000;
 
-	var1 = ((int64_t)calib_data->t_fine) - 128000;
-	var2 = var1 * var1 * (int64_t)calib_data->dig_P6;
-	var2 = var2 + ((var1 * (int64_t)calib_data->dig_P5) * 131072);
-	var2 = var2 + (((int64_t)calib_data->dig_P4) * 34359738368);
-	var1 = ((var1 * var1 * (int64_t)calib_data->dig_P3) / 256) + ((var1 * ((int64_t)calib_data->dig_P2) * 4096));
-	var3 = ((int64_t)1) * 140737488355328;
-	var1 = (var3 + var1) * ((int64_t)calib_data->dig_P1) / 8589934592;
+	var1 = ((int64_t)t_fine) - 128000;
+	var2 = var1 * var1 * coeffs->p6 + var1 * coeffs->p5 + coeffs->p4;
+	var1 = ((var1 * var1 * coeffs->p3) / 256) + var1 * coeffs->p2;
+	var1 = (140737488355328 + var1) * coeffs->p1 / 8589934592;
 
 	/* To avoid divide by zero exception */
 	if (var1 != 0) {
-		var4 = 1048576 - uncomp_data->pressure;
+		var4 = 1048576 - uncomp_pressure;
 		var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
-		var1 = (((int64_t)calib_data->dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
-		var2 = (((int64_t)calib_data->dig_P8) * var4) / 524288;
-		var4 = ((var4 + var1 + var2) / 256) + (((int64_t)calib_data->dig_P7) * 16);
+		var1 = (coeffs->p9 * (var4 / 8192) * (var4 / 8192)) / 33554432;
+		var2 = (coeffs->p8 * var4) / 524288;
+		var4 = ((var4 + var1 + var2) / 256) + coeffs->p7;
 		pressure = (uint32_t)(((var4 / 2) * 100) / 128);
 
-		if (pressure < pressure_min)
-			pressure = pressure_min;
-		else if (pressure > pressure_max)
-			pressure = pressure_max;
+		pressure = pressure < pressure_min ? pressure_min : pressure;
+		pressure = pressure > pressure_max ? pressure_max : pressure;
 	} else {
 		pressure = pressure_min;
 	}
@@ -1053,11 +1480,11 @@ static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data
 }
 #else
 /*!
- * @brief This internal API is used to compensate the raw pressure data and
- * return the compensated pressure data in integer data type.
+ * @brief This internal API compensates the raw pressure data with the derived
+ * coefficients.
  */
-static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data)
+static inline uint32_t compensate_pressure(uint32_t uncomp_pressure, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs)
 {
 	int32_t var1;
 	int32_t var2;
@@ -1068,31 +1495,29 @@ static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data
 	uint32_t pressure_min = 30000;
 	uint32_t pressure_max = 110000;
 
-	var1 = (((int32_t)calib_data->t_fine) / 2) - (int32_t)64000;
-	var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t)calib_data->dig_P6);
-	var2 = var2 + ((var1 * ((int32_t)calib_data->dig_P5)) * 2);
-	var2 = (var2 / 4) + (((int32_t)calib_data->dig_P4) * 65536);
-	var3 = (calib_data->dig_P3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8;
-	var4 = (((int32_t)calib_data->dig_P2) * var1) / 2;
+	var1 = (t_fine / 2) - (int32_t)64000;
+	var3 = ((var1 / 4) * (var1 / 4)) / 2048;
+	var2 = var3 * coeffs->p6 + var1 * coeffs->p5;
+	var2 = (var2 / 4) + coeffs->p4;
+	var3 = (coeffs->p3 * (var3 / 4)) / 8;
+	var4 = (coeffs->p2 * var1) / 2;
 	var1 = (var3 + var4) / 262144;
-	var1 = (((32768 + var1)) * ((int32_t)calib_data->dig_P1)) / 32768;
+	var1 = ((32768 + var1) * coeffs->p1) / 32768;
 	 /* avoid exception caused by division by zero */
 	if (var1) {
-		var5 = (uint32_t)((uint32_t)1048576) - uncomp_data->pressure;
+		var5 = (uint32_t)((uint32_t)1048576) - uncomp_pressure;
 		pressure = ((uint32_t)(var5 - (uint32_t)(var2 / 4096))) * 3125;
 		if (pressure < 0x80000000)
 			pressure = (pressure << 1) / ((uint32_t)var1);
 		else
 			pressure = (pressure / (uint32_t)var1) * 2;
 
-		var1 = (((int32_t)calib_data->dig_P9) * ((int32_t)(((pressure / 8) * (pressure / 8)) / 8192))) / 4096;
-		var2 = (((int32_t)(pressure / 4)) * ((int32_t)calib_data->dig_P8)) / 8192;
-		pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + calib_data->dig_P7) / 16));
+		var1 = (coeffs->p9 * ((int32_t)(((pressure / 8) * (pressure / 8)) / 8192))) / 4096;
+		var2 = (((int32_t)(pressure / 4)) * coeffs->p8) / 8192;
+		pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + coeffs->p7) / 16));
 
-		if (pressure < pressure_min)
-			pressure = pressure_min;
-		else if (pressure > pressure_max)
-			pressure = pressure_max;
+		pressure = pressure < pressure_min ? pressure_min : pressure;
+		pressure = pressure > pressure_max ? pressure_max : pressure;
 	} else {
 		pressure = pressure_min;
 	}
@@ -1102,11 +1527,11 @@ static uint32_t compensate_pressure(const struct bme280_uncomp_data *uncomp_data
 #endif
 
 /*!
- * @brief This internal API is used to compensate the raw humidity data and
- * return the compensated humidity data in integer data type.
+ * @brief This internal API compensates the raw humidity data with the derived
+ * coefficients.
  */
-static uint32_t compensate_humidity(const struct bme280_uncomp_data *uncomp_data,
-						const struct bme280_calib_data *calib_data)
+static inline uint32_t compensate_humidity(uint32_t uncomp_humidity, int32_t t_fine,
+					const struct bme280_calib_coeffs *coeffs)
 {
 	int32_t var1;
 	int32_t var2;
@@ -1116,29 +1541,82 @@ static uint32_t compensate_humidity(const struct bme280_uncomp_data *uncomp_data
 	uint32_t humidity;
 	uint32_t humidity_max = 102400;
 
-	var1 = calib_data->t_fine - ((int32_t)76800);
-	var2 = (int32_t)(uncomp_data->humidity * 16384);
-	var3 = (int32_t)(((int32_t)calib_data->dig_H4) * 1048576);
-	var4 = ((int32_t)calib_data->dig_H5) * var1;
-	var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
-	var2 = (var1 * ((int32_t)calib_data->dig_H6)) / 1024;
-	var3 = (var1 * ((int32_t)calib_data->dig_H3)) / 2048;
+	var1 = t_fine - ((int32_t)76800);
+	var2 = (int32_t)(uncomp_humidity * 16384);
+	var5 = (((var2 - coeffs->h4) - coeffs->h5 * var1) + (int32_t)16384) / 32768;
+	var2 = (var1 * coeffs->h6) / 1024;
+	var3 = (var1 * coeffs->h3) / 2048;
 	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
-	var2 = ((var4 * ((int32_t)calib_data->dig_H2)) + 8192) / 16384;
+	var2 = ((var4 * coeffs->h2) + 8192) / 16384;
 	var3 = var5 * var2;
 	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
-	var5 = var3 - ((var4 * ((int32_t)calib_data->dig_H1)) / 16);
+	var5 = var3 - ((var4 * coeffs->h1) / 16);
 	var5 = (var5 < 0 ? 0 : var5);
 	var5 = (var5 > 419430400 ? 419430400 : var5);
 	humidity = (uint32_t)(var5 / 4096);
 
-	if (humidity > humidity_max)
-		humidity = humidity_max;
+	humidity = humidity > humidity_max ? humidity_max : humidity;
 
 	return humidity;
 }
 #endif
 
+/*!
+ * @brief This internal API compensates a block of raw temperature values.
+ * The coefficients are copied into locals, so that the stores to comp and
+ * t_fine cannot change them within the loop.
+ */
+#ifdef BME280_FLOAT_ENABLE
+static void compensate_temperature_batch(const uint32_t *BME280_RESTRICT temp, size_t len, double *BME280_RESTRICT comp,
+					 int32_t *BME280_RESTRICT t_fine, const struct bme280_calib_coeffs *coeffs)
+#else
+static void compensate_temperature_batch(const uint32_t *BME280_RESTRICT temp, size_t len, int32_t *BME280_RESTRICT comp,
+					 int32_t *BME280_RESTRICT t_fine, const struct bme280_calib_coeffs *coeffs)
+#endif
+{
+	const struct bme280_calib_coeffs local = *coeffs;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		comp[i] = compensate_temperature(temp[i], &local, &t_fine[i]);
+}
+
+/*!
+ * @brief This internal API compensates a block of raw pressure values.
+ */
+#ifdef BME280_FLOAT_ENABLE
+static void compensate_pressure_batch(const uint32_t *BME280_RESTRICT press, const int32_t *BME280_RESTRICT t_fine,
+				      size_t len, double *BME280_RESTRICT comp, const struct bme280_calib_coeffs *coeffs)
+#else
+static void compensate_pressure_batch(const uint32_t *BME280_RESTRICT press, const int32_t *BME280_RESTRICT t_fine,
+				      size_t len, uint32_t *BME280_RESTRICT comp, const struct bme280_calib_coeffs *coeffs)
+#endif
+{
+	const struct bme280_calib_coeffs local = *coeffs;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		comp[i] = compensate_pressure(press[i], t_fine[i], &local);
+}
+
+/*!
+ * @brief This internal API compensates a block of raw humidity values.
+ */
+#ifdef BME280_FLOAT_ENABLE
+static void compensate_humidity_batch(const uint16_t *BME280_RESTRICT hum, const int32_t *BME280_RESTRICT t_fine,
+				      size_t len, double *BME280_RESTRICT comp, const struct bme280_calib_coeffs *coeffs)
+#else
+static void compensate_humidity_batch(const uint16_t *BME280_RESTRICT hum, const int32_t *BME280_RESTRICT t_fine,
+				      size_t len, uint32_t *BME280_RESTRICT comp, const struct bme280_calib_coeffs *coeffs)
+#endif
+{
+	const struct bme280_calib_coeffs local = *coeffs;
+	size_t i;
+
+	for (i = 0; i < len; i++)
+		comp[i] = compensate_humidity(hum[i], t_fine[i], &local);
+}
+
 /*!
  * @brief This internal API reads the calibration data from the sensor, parse
  * it and store in the device structure.
@@ -1165,6 +1643,7 @@ static int8_t get_calib_data(struct bme280_dev *dev)
 			/* Parse humidity calibration data and store it in
 			   device structure */
 			parse_humidity_calib_data(calib_data, dev);
+			dev->calib_data.coeffs.valid = 1;
 		}
 	}
 
@@ -1206,7 +1685,8 @@ static void parse_temp_press_calib_data(const uint8_t *reg_data, struct bme280_d
 	calib_data->dig_P8 = (int16_t)BME280_CONCAT_BYTES(reg_data[21], reg_data[20]);
 	calib_data->dig_P9 = (int16_t)BME280_CONCAT_BYTES(reg_data[23], reg_data[22]);
 	calib_data->dig_H1 = reg_data[25];
-
+	calib_data->coeffs.valid = 0;
+	derive_temp_press_coeffs(calib_data);
 }
 
 /*!
@@ -1232,6 +1712,7 @@ static void parse_humidity_calib_data(const uint8_t *reg_data, struct bme280_dev
 	dig_H5_lsb = (int16_t)(reg_data[4] >> 4);
 	calib_data->dig_H5 = dig_H5_msb | dig_H5_lsb;
 	calib_data->dig_H6 = (int8_t)reg_data[6];
+	derive_humidity_coeffs(calib_data);
 }
 
 /*!
@@ -1253,6 +1734,17 @@ static uint8_t are_settings_changed(uint8_t sub_settings, uint8_t desired_settin
 	return settings_changed;
 }
 
+/*!
+ * @brief This internal API waits for the given number of microseconds.
+ */
+static void delay_us(uint32_t period, const struct bme280_dev *dev)
+{
+	if (dev->delay_us != NULL)
+		dev->delay_us(period);
+	else
+		dev->delay_ms((period + 999) / 1000);
+}
+
 /*!
  * @brief This internal API is used to validate the device structure pointer for
  * null conditions.
@@ -196,6 +196,10 @@ int8_t bme280_soft_reset(const struct bme280_dev *dev);
  *     4       | BME280_HUM
  *     7       | BME280_ALL
  *
+ * Only the data registers of the selected channels are read, e.g. 0xFA..0xFE
+ * for BME280_TEMP | BME280_HUM. Temperature is always read, as the other
+ * channels are compensated with it.
+ *
  * @param[out] comp_data : Structure instance of bme280_data.
  * @param[in] dev : Structure instance of bme280_dev.
  *
@@ -233,6 +237,110 @@ void bme280_parse_sensor_data(const uint8_t *reg_data, struct bme280_uncomp_data
 int8_t bme280_compensate_data(uint8_t sensor_comp, const struct bme280_uncomp_data *uncomp_data,
 				     struct bme280_data *comp_data, struct bme280_calib_data *calib_data);
 
+/*!
+ * @brief This API derives the compensation coefficients from the trim values
+ * in calib_data. The driver does so when it reads the calibration from the
+ * sensor, and bme280_compensate_data when it gets calibration data without
+ * them. Call it again after changing the trim values of calibration data
+ * that has been used for compensation.
+ *
+ * @param[in,out] calib_data : Structure instance of bme280_calib_data.
+ */
+void bme280_derive_calib_coeffs(struct bme280_calib_data *calib_data);
+
+/*!
+ * @brief This API compensates many raw samples at once, e.g. readings that
+ * were stored uncompensated and are processed later. The raw values and the
+ * results are kept in one array per channel. Each channel is compensated in
+ * a loop of its own over blocks of samples, with the per-sample arithmetic
+ * of bme280_compensate_data and the same results.
+ *
+ * @param[in] press : Raw pressure values, NULL to skip the pressure.
+ * @param[in] temp : Raw temperature values, always needed.
+ * @param[in] hum : Raw humidity values, NULL to skip the humidity.
+ * @param[in] n : Number of samples.
+ * @param[out] comp_data : Output arrays of n elements each, a NULL array
+ * skips that channel.
+ * @param[in] calib_data : Structure instance of bme280_calib_data, t_fine is
+ * not updated.
+ *
+ * @return Result of API execution status.
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bme280_compensate_batch(const uint32_t *press, const uint32_t *temp, const uint16_t *hum, size_t n,
+			       const struct bme280_batch_data *comp_data, const struct bme280_calib_data *calib_data);
+
+/*!
+ * @brief This API calculates the typical and maximum time a measurement
+ * takes with the given oversampling settings, as given in section 9.1 of
+ * the data sheet.
+ *
+ * @param[in] settings : Structure instance of bme280_settings.
+ * @param[out] typ_us : Typical measurement time in microseconds.
+ * @param[out] max_us : Maximum measurement time in microseconds.
+ */
+void bme280_calc_measurement_time(const struct bme280_settings *settings, uint32_t *typ_us, uint32_t *max_us);
+
+/*!
+ * @brief This API starts a measurement in forced mode with the current
+ * oversampling settings and returns immediately. The humidity control
+ * register is written in the same burst as ctrl_meas, assuming that the
+ * sensor is in sleep mode.
+ *
+ * @param[in,out] dev : Structure instance of bme280_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bme280_trigger_measurement(struct bme280_dev *dev);
+
+/*!
+ * @brief This API checks whether the measurement started by
+ * bme280_trigger_measurement has completed. The conversion is complete once
+ * the sensor has left forced mode and the measuring bit is cleared, both are
+ * read in a single burst.
+ *
+ * @param[out] ready : 1 if the result can be fetched, 0 otherwise.
+ * @param[in,out] dev : Structure instance of bme280_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ */
+int8_t bme280_poll_measurement(uint8_t *ready, struct bme280_dev *dev);
+
+/*!
+ * @brief This API reads and compensates the result of the measurement
+ * started by bme280_trigger_measurement, polling once if it has not been
+ * seen completed yet.
+ *
+ * @param[in] sensor_comp : Variable which selects which data to be read,
+ * as in bme280_get_sensor_data.
+ * @param[out] comp_data : Structure instance of bme280_data.
+ * @param[in,out] dev : Structure instance of bme280_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ * @retval BME280_E_MEAS_NOT_READY -> the conversion is still running
+ */
+int8_t bme280_fetch_measurement(uint8_t sensor_comp, struct bme280_data *comp_data, struct bme280_dev *dev);
+
+/*!
+ * @brief This API waits until the measurement started by
+ * bme280_trigger_measurement has completed. It waits for what is left of
+ * the typical measurement time of the current settings and then polls every
+ * millisecond, until the maximum measurement time has passed. Both are
+ * counted from the trigger when dev->time_us is set, and from this call
+ * otherwise.
+ *
+ * @param[in,out] dev : Structure instance of bme280_dev.
+ *
+ * @return Result of API execution status
+ * @retval zero -> Success / -ve value -> Error
+ * @retval BME280_E_MEAS_TIMEOUT -> the conversion took longer than the
+ * maximum measurement time
+ */
+int8_t bme280_wait_for_measurement(struct bme280_dev *dev);
+
 #ifdef __cplusplus
 }
 #endif /* End of CPP guard */
@@ -132,6 +132,7 @@
 #define BME280_HUMIDITY_CALIB_DATA_ADDR		UINT8_C(0xE1)
 #define BME280_PWR_CTRL_ADDR				UINT8_C(0xF4)
 #define BME280_CTRL_HUM_ADDR				UINT8_C(0xF2)
+#define BME280_STATUS_ADDR					UINT8_C(0xF3)
 #define BME280_CTRL_MEAS_ADDR				UINT8_C(0xF4)
 #define BME280_CONFIG_ADDR					UINT8_C(0xF5)
 #define BME280_DATA_ADDR					UINT8_C(0xF7)
@@ -145,6 +146,9 @@
 #define BME280_E_INVALID_LEN		INT8_C(-3)
 #define BME280_E_COMM_FAIL			INT8_C(-4)
 #define BME280_E_SLEEP_MODE_FAIL	INT8_C(-5)
+#define BME280_E_MEAS_TIMEOUT		INT8_C(-6)
+#define BME280_E_NO_MEASUREMENT		INT8_C(-7)
+#define BME280_E_MEAS_NOT_READY		INT8_C(-8)
 
 /**\name API warning codes */
 #define BME280_W_INVALID_OSR_MACRO      INT8_C(1)
@@ -153,6 +157,9 @@
 #define BME280_TEMP_PRESS_CALIB_DATA_LEN	UINT8_C(26)
 #define BME280_HUMIDITY_CALIB_DATA_LEN		UINT8_C(7)
 #define BME280_P_T_H_DATA_LEN				UINT8_C(8)
+/* Offsets of the temperature and humidity data from BME280_DATA_ADDR */
+#define BME280_TEMP_DATA_OFFSET				UINT8_C(3)
+#define BME280_HUM_DATA_OFFSET				UINT8_C(6)
 
 /**\name Sensor power modes */
 #define	BME280_SLEEP_MODE		UINT8_C(0x00)
@@ -192,6 +199,9 @@
 #define BME280_STANDBY_MSK		UINT8_C(0xE0)
 #define BME280_STANDBY_POS		UINT8_C(0x05)
 
+#define BME280_STATUS_MEAS_MSK	UINT8_C(0x08)
+#define BME280_STATUS_MEAS_POS	UINT8_C(0x03)
+
 /**\name Sensor component selection macros
    These values are internal for API implementation. Don't relate this to
    data sheet.*/
@@ -243,6 +253,18 @@ enum bme280_intf {
 	BME280_I2C_INTF
 };
 
+/*!
+ * @brief State of a measurement started by bme280_trigger_measurement
+ */
+enum bme280_meas_state {
+	/*! No measurement started */
+	BME280_MEAS_IDLE,
+	/*! Conversion started, result not yet seen */
+	BME280_MEAS_PENDING,
+	/*! Conversion completed, result not yet fetched */
+	BME280_MEAS_READY
+};
+
 /*!
  * @brief Type definitions
  */
@@ -251,6 +273,73 @@ typedef int8_t (*bme280_com_fptr_t)(uint8_t dev_id, uint8_t reg_addr,
 
 typedef void (*bme280_delay_fptr_t)(uint32_t period);
 
+typedef uint32_t (*bme280_time_fptr_t)(void);
+
+/*!
+ * @brief Compensation coefficients derived from the trim values when the
+ * calibration data is parsed, so that the compensation does not recombine
+ * them for every sample. Scaling by powers of two is folded in only where it
+ * is exact, the results are exactly those of the data sheet formulas.
+ */
+struct bme280_calib_coeffs {
+	/*! Non-zero once the coefficients have been derived, first so that { 0 }
+	    initializes calibration data without them */
+	uint8_t valid;
+#ifdef BME280_FLOAT_ENABLE
+	double t1_1024;		/* dig_T1 / 2^10 */
+	double t1_8192;		/* dig_T1 / 2^13 */
+	double t2;
+	double t3;
+	double p1;
+	double p2;		/* dig_P2 / 2^34 */
+	double p3;		/* dig_P3 / 2^53 */
+	double p4;		/* dig_P4 * 2^4 */
+	double p5;		/* dig_P5 / 2^13 */
+	double p6;		/* dig_P6 / 2^29 */
+	double p7;		/* dig_P7 / 2^4 */
+	double p8;		/* dig_P8 / 2^19 */
+	double p9;		/* dig_P9 / 2^35 */
+	double h1;		/* dig_H1 / 2^19 */
+	double h2;		/* dig_H2 / 2^16 */
+	double h3;		/* dig_H3 / 2^26 */
+	double h4;		/* dig_H4 * 2^6 */
+	double h5;		/* dig_H5 / 2^14 */
+	double h6;		/* dig_H6 / 2^26 */
+#else
+	int32_t t1;
+	int32_t t1x2;		/* dig_T1 * 2 */
+	int32_t t2;
+	int32_t t3;
+#ifdef BME280_64BIT_ENABLE
+	int64_t p1;
+	int64_t p2;		/* dig_P2 * 2^12 */
+	int64_t p3;
+	int64_t p4;		/* dig_P4 * 2^35 */
+	int64_t p5;		/* dig_P5 * 2^17 */
+	int64_t p6;
+	int64_t p7;		/* dig_P7 * 2^4 */
+	int64_t p8;
+	int64_t p9;
+#else
+	int32_t p1;
+	int32_t p2;
+	int32_t p3;
+	int32_t p4;		/* dig_P4 * 2^16 */
+	int32_t p5;		/* dig_P5 * 2 */
+	int32_t p6;
+	int32_t p7;
+	int32_t p8;
+	int32_t p9;
+#endif
+	int32_t h1;
+	int32_t h2;
+	int32_t h3;
+	int32_t h4;		/* dig_H4 * 2^20 */
+	int32_t h5;
+	int32_t h6;
+#endif
+};
+
 /*!
  * @brief Calibration data
  */
@@ -279,6 +368,8 @@ struct bme280_calib_data {
 	int8_t  dig_H6;
 	int32_t t_fine;
 /**@}*/
+	/*! Derived from the trim values, see bme280_derive_calib_coeffs */
+	struct bme280_calib_coeffs coeffs;
 };
 
 /*!
@@ -305,6 +396,30 @@ struct bme280_data {
 };
 #endif /* BME280_USE_FLOATING_POINT */
 
+/*!
+ * @brief Output arrays of bme280_compensate_batch, one element per sample.
+ * A NULL array skips the compensation of that channel.
+ */
+#ifdef BME280_FLOAT_ENABLE
+struct bme280_batch_data {
+	/*! Compensated pressure */
+	double *pressure;
+	/*! Compensated temperature */
+	double *temperature;
+	/*! Compensated humidity */
+	double *humidity;
+};
+#else
+struct bme280_batch_data {
+	/*! Compensated pressure */
+	uint32_t *pressure;
+	/*! Compensated temperature */
+	int32_t *temperature;
+	/*! Compensated humidity */
+	uint32_t *humidity;
+};
+#endif
+
 /*!
  * @brief bme280 sensor structure which comprises of uncompensated temperature,
  * pressure and humidity data
@@ -351,10 +466,20 @@ struct bme280_dev {
 	bme280_com_fptr_t write;
 	/*! Delay function pointer */
 	bme280_delay_fptr_t delay_ms;
+	/*! Optional microsecond delay, used by bme280_wait_for_measurement
+	    instead of delay_ms */
+	bme280_delay_fptr_t delay_us;
+	/*! Optional microsecond clock, lets bme280_wait_for_measurement count
+	    from the trigger. It may wrap around. */
+	bme280_time_fptr_t time_us;
 	/*! Trim data */
 	struct bme280_calib_data calib_data;
 	/*! Sensor settings */
 	struct bme280_settings settings;
+	/*! State of the split-phase measurement */
+	enum bme280_meas_state meas_state;
+	/*! time_us when the measurement was triggered */
+	uint32_t meas_start_us;
 };
 
 #endif /* BME280_DEFS_H_ */
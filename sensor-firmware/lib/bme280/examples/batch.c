@@ -0,0 +1,133 @@
+/*
+  Compares the speed of bme280_compensate_batch with one bme280_compensate_data
+  call per sample, on raw readings around room conditions as stored by a
+  gateway. test/test_bme280_batch checks that both give the same results.
+
+  compile like this: gcc -O3 batch.c ../bme280.c -I .. -I ../../../test -o batch
+  add -DBME280_64BIT_ENABLE or -DBME280_FLOAT_ENABLE for the other variants
+  usage: ./batch [samples]
+*/
+#include "bme280.h"
+#include "bme280_fixture.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef BME280_FLOAT_ENABLE
+#define VARIANT "double"
+typedef double pressure_t;
+typedef double temperature_t;
+typedef double humidity_t;
+#else
+#ifdef BME280_64BIT_ENABLE
+#define VARIANT "int64"
+#else
+#define VARIANT "int32"
+#endif
+typedef uint32_t pressure_t;
+typedef int32_t temperature_t;
+typedef uint32_t humidity_t;
+#endif
+
+static double seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+struct samples {
+    size_t n;
+    uint32_t *press, *temp;
+    uint16_t *hum;
+    pressure_t *pressure;
+    temperature_t *temperature;
+    humidity_t *humidity;
+};
+
+static void allocate(struct samples *samples, size_t n) {
+    samples->n = n;
+    samples->press = malloc(n * sizeof(uint32_t));
+    samples->temp = malloc(n * sizeof(uint32_t));
+    samples->hum = malloc(n * sizeof(uint16_t));
+    samples->pressure = malloc(n * sizeof(pressure_t));
+    samples->temperature = malloc(n * sizeof(temperature_t));
+    samples->humidity = malloc(n * sizeof(humidity_t));
+    if (!samples->press || !samples->temp || !samples->hum || !samples->pressure || !samples->temperature ||
+        !samples->humidity) {
+        fprintf(stderr, "out of memory\n");
+        exit(2);
+    }
+}
+
+static void release(struct samples *samples) {
+    free(samples->press);
+    free(samples->temp);
+    free(samples->hum);
+    free(samples->pressure);
+    free(samples->temperature);
+    free(samples->humidity);
+}
+
+/* raw values around room conditions, in no particular order */
+static void fill_room(struct samples *samples) {
+    for (size_t i = 0; i < samples->n; i++) {
+        samples->temp[i] = 512000 + next_random() % 24000;
+        samples->press[i] = 300000 + next_random() % 40000;
+        samples->hum[i] = 23000 + next_random() % 10000;
+    }
+}
+
+/* what the gateway does without the batch API, one bme280_compensate_data call per sample */
+static void compensate_scalar(uint8_t sensor_comp, const struct samples *samples,
+                              struct bme280_calib_data *calib_data) {
+    for (size_t i = 0; i < samples->n; i++) {
+        struct bme280_uncomp_data uncomp = { samples->press[i], samples->temp[i], samples->hum[i] };
+        struct bme280_data data;
+        bme280_compensate_data(sensor_comp, &uncomp, &data, calib_data);
+        samples->pressure[i] = data.pressure;
+        samples->temperature[i] = data.temperature;
+        samples->humidity[i] = data.humidity;
+    }
+}
+
+static void compensate_batch(uint8_t sensor_comp, const struct samples *samples,
+                             const struct bme280_calib_data *calib_data) {
+    struct bme280_batch_data comp_data = {
+        sensor_comp & BME280_PRESS ? samples->pressure : NULL,
+        samples->temperature,
+        sensor_comp & BME280_HUM ? samples->humidity : NULL
+    };
+
+    bme280_compensate_batch(samples->press, samples->temp, samples->hum, samples->n, &comp_data, calib_data);
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1 << 22;
+    struct bme280_calib_data calib_data = calibrations[0];
+    struct samples samples;
+
+    bme280_derive_calib_coeffs(&calib_data);
+    allocate(&samples, n);
+    fill_room(&samples);
+
+    printf("%s compensation, %zu samples, ns per sample\n", VARIANT, n);
+    printf("%-18s %8s %8s %8s\n", "channels", "scalar", "batch", "speedup");
+
+    const uint8_t channels[] = { BME280_ALL, BME280_TEMP | BME280_HUM, BME280_TEMP };
+    const char *names[] = { "all", "temp, humidity", "temp" };
+    for (size_t c = 0; c < sizeof(channels); c++) {
+        double start = seconds();
+        compensate_scalar(channels[c], &samples, &calib_data);
+        double scalar = seconds() - start;
+
+        start = seconds();
+        compensate_batch(channels[c], &samples, &calib_data);
+        double batch = seconds() - start;
+
+        printf("%-18s %8.2f %8.2f %7.1fx\n", names[c], scalar * 1e9 / n, batch * 1e9 / n, scalar / batch);
+    }
+
+    release(&samples);
+    return 0;
+}
@@ -64,6 +64,10 @@ extern "C"
 /**\name API warning code */
 #define BME280_W_SELF_TEST_FAIL         INT8_C(2)
 
+/**\name Register holding the CRC of the calibration data */
+#define BME280_CRC_DATA_ADDR	UINT8_C(0xE8)
+#define BME280_CRC_DATA_LEN	UINT8_C(1)
+
 /*!
  * @brief This API reads the stored CRC and then compare with calculated CRC
  *
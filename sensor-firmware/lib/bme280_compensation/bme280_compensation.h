@@ -0,0 +1,286 @@
+#ifndef BME280_COMPENSATION_H_
+#define BME280_COMPENSATION_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bme280_defs.h"
+
+// Compensation of raw BME280 readings with the formulas of the driver, as
+// C++ templates instead of the build wide BME280_FLOAT_ENABLE and
+// BME280_64BIT_ENABLE switches. All representations can be used in one
+// program, e.g. double on a gateway and int32 on the sensor, and compared
+// against each other. Only the trim values of bme280_calib_data are read, so
+// the driver may be built in any flavour.
+//
+// An Engine is instantiated for one representation and a channel mask of
+// BME280_PRESS, BME280_TEMP and BME280_HUM; the channels not in the mask are
+// not computed at all. Each representation gives the same results as the
+// driver built in the matching flavour. select() picks an instantiation at
+// runtime.
+namespace BME280Compensation {
+    // °C, Pa and % relative humidity, like BME280_FLOAT_ENABLE
+    struct Double {
+        typedef double temperature_t;
+        typedef double pressure_t;
+        typedef double humidity_t;
+        static constexpr double temperature_unit = 1;
+        static constexpr double pressure_unit = 1;
+        static constexpr double humidity_unit = 1;
+    };
+
+    // 0.01 °C, Pa and 1/1024 % relative humidity, like the default flavour
+    struct Int32 {
+        typedef int32_t temperature_t;
+        typedef uint32_t pressure_t;
+        typedef uint32_t humidity_t;
+        static constexpr double temperature_unit = 0.01;
+        static constexpr double pressure_unit = 1;
+        static constexpr double humidity_unit = 1.0 / 1024;
+    };
+
+    // as Int32, but pressure in 0.01 Pa, like BME280_64BIT_ENABLE
+    struct Int64 {
+        typedef int32_t temperature_t;
+        typedef uint32_t pressure_t;
+        typedef uint32_t humidity_t;
+        static constexpr double temperature_unit = 0.01;
+        static constexpr double pressure_unit = 0.01;
+        static constexpr double humidity_unit = 1.0 / 1024;
+    };
+
+    template <typename Representation> struct Reading {
+        typename Representation::temperature_t temperature;
+        typename Representation::pressure_t pressure;
+        typename Representation::humidity_t humidity;
+    };
+
+    // a reading of any representation in °C, Pa and % relative humidity
+    struct Values {
+        double temperature;
+        double pressure;
+        double humidity;
+    };
+
+    template <typename Representation> Values toValues(const Reading<Representation> &reading) {
+        return { reading.temperature * Representation::temperature_unit,
+                 reading.pressure * Representation::pressure_unit,
+                 reading.humidity * Representation::humidity_unit };
+    }
+
+    // The trim values converted and multiplied by the constant factors of
+    // the formulas, once per calibration. Only powers of two are folded in,
+    // so the results stay exactly those of the driver.
+    template <typename Representation> struct Formulas;
+
+    template <> struct Formulas<Double> {
+        double t1_1024, t1_8192, t2, t3;
+        double p1, p2, p3, p4, p5, p6, p7, p8, p9;
+        double h1, h2, h3, h4, h5, h6;
+
+        explicit Formulas(const bme280_calib_data &calib)
+            : t1_1024(calib.dig_T1 / 1024.0), t1_8192(calib.dig_T1 / 8192.0), t2(calib.dig_T2), t3(calib.dig_T3),
+              p1(calib.dig_P1), p2(calib.dig_P2 / 17179869184.0), p3(calib.dig_P3 / 9007199254740992.0),
+              p4(calib.dig_P4 * 16.0), p5(calib.dig_P5 / 8192.0), p6(calib.dig_P6 / 536870912.0),
+              p7(calib.dig_P7 / 16.0), p8(calib.dig_P8 / 524288.0), p9(calib.dig_P9 / 34359738368.0),
+              h1(calib.dig_H1 / 524288.0), h2(calib.dig_H2 / 65536.0), h3(calib.dig_H3 / 67108864.0),
+              h4(calib.dig_H4 * 64.0), h5(calib.dig_H5 / 16384.0), h6(calib.dig_H6 / 67108864.0) {}
+
+        double temperature(uint32_t adc, int32_t &t_fine) const {
+            double var1 = (adc / 16384.0 - t1_1024) * t2;
+            double var2 = adc / 131072.0 - t1_8192;
+            var2 = (var2 * var2) * t3;
+            t_fine = (int32_t)(var1 + var2);
+            double temperature = (var1 + var2) / 5120.0;
+            return temperature < -40 ? -40 : temperature > 85 ? 85 : temperature;
+        }
+
+        double pressure(uint32_t adc, int32_t t_fine) const {
+            double var1 = (t_fine / 2.0) - 64000.0;
+            double var2 = var1 * var1 * p6 + var1 * p5 + p4;
+            var1 = (1.0 + (p3 * var1 * var1 + p2 * var1)) * p1;
+            if (!var1) return 30000.0; // avoid the division by zero
+
+            double pressure = 1048576.0 - adc;
+            pressure = (pressure - var2) * 6250.0 / var1;
+            var1 = p9 * pressure * pressure;
+            var2 = pressure * p8;
+            pressure = pressure + (var1 + var2 + p7);
+            return pressure < 30000.0 ? 30000.0 : pressure > 110000.0 ? 110000.0 : pressure;
+        }
+
+        double humidity(uint32_t adc, int32_t t_fine) const {
+            double var1 = t_fine - 76800.0;
+            double var5 = 1.0 + h3 * var1;
+            double var6 = 1.0 + h6 * var1 * var5;
+            var6 = (adc - (h4 + h5 * var1)) * h2 * (var5 * var6);
+            double humidity = var6 * (1.0 - h1 * var6);
+            return humidity > 100.0 ? 100.0 : humidity < 0.0 ? 0.0 : humidity;
+        }
+    };
+
+    // temperature and humidity of both integer representations
+    template <typename Pressure> struct IntegerFormulas {
+        int32_t t1, t1x2, t2, t3;
+        Pressure p1, p2, p3, p4, p5, p6, p7, p8, p9;
+        int32_t h1, h2, h3, h4, h5, h6;
+
+        explicit IntegerFormulas(const bme280_calib_data &calib)
+            : t1(calib.dig_T1), t1x2(calib.dig_T1 * 2), t2(calib.dig_T2), t3(calib.dig_T3),
+              h1(calib.dig_H1), h2(calib.dig_H2), h3(calib.dig_H3), h4(calib.dig_H4 * 1048576),
+              h5(calib.dig_H5), h6(calib.dig_H6) {}
+
+        int32_t temperature(uint32_t adc, int32_t &t_fine) const {
+            int32_t var1 = (int32_t)((adc / 8) - t1x2);
+            var1 = (var1 * t2) / 2048;
+            int32_t var2 = (int32_t)((adc / 16) - t1);
+            var2 = (((var2 * var2) / 4096) * t3) / 16384;
+            t_fine = var1 + var2;
+            int32_t temperature = (t_fine * 5 + 128) / 256;
+            return temperature < -4000 ? -4000 : temperature > 8500 ? 8500 : temperature;
+        }
+
+        uint32_t humidity(uint32_t adc, int32_t t_fine) const {
+            int32_t var1 = t_fine - 76800;
+            int32_t var2 = (int32_t)(adc * 16384);
+            int32_t var5 = (((var2 - h4) - h5 * var1) + 16384) / 32768;
+            var2 = (var1 * h6) / 1024;
+            int32_t var3 = (var1 * h3) / 2048;
+            int32_t var4 = ((var2 * (var3 + 32768)) / 1024) + 2097152;
+            var2 = ((var4 * h2) + 8192) / 16384;
+            var3 = var5 * var2;
+            var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+            var5 = var3 - ((var4 * h1) / 16);
+            var5 = var5 < 0 ? 0 : var5 > 419430400 ? 419430400 : var5;
+            uint32_t humidity = (uint32_t)(var5 / 4096);
+            return humidity > 102400 ? 102400 : humidity;
+        }
+    };
+
+    template <> struct Formulas<Int32> : IntegerFormulas<int32_t> {
+        explicit Formulas(const bme280_calib_data &calib) : IntegerFormulas(calib) {
+            p1 = calib.dig_P1;
+            p2 = calib.dig_P2;
+            p3 = calib.dig_P3;
+            p4 = calib.dig_P4 * 65536;
+            p5 = calib.dig_P5 * 2;
+            p6 = calib.dig_P6;
+            p7 = calib.dig_P7;
+            p8 = calib.dig_P8;
+            p9 = calib.dig_P9;
+        }
+
+        uint32_t pressure(uint32_t adc, int32_t t_fine) const {
+            int32_t var1 = (t_fine / 2) - 64000;
+            int32_t var3 = ((var1 / 4) * (var1 / 4)) / 2048;
+            int32_t var2 = var3 * p6 + var1 * p5;
+            var2 = (var2 / 4) + p4;
+            var3 = (p3 * (var3 / 4)) / 8;
+            int32_t var4 = (p2 * var1) / 2;
+            var1 = (var3 + var4) / 262144;
+            var1 = ((32768 + var1) * p1) / 32768;
+            if (!var1) return 30000; // avoid the division by zero
+
+            uint32_t pressure = ((uint32_t)((1048576 - adc) - (uint32_t)(var2 / 4096))) * 3125;
+            if (pressure < 0x80000000)
+                pressure = (pressure << 1) / (uint32_t)var1;
+            else
+                pressure = (pressure / (uint32_t)var1) * 2;
+
+            var1 = (p9 * (int32_t)(((pressure / 8) * (pressure / 8)) / 8192)) / 4096;
+            var2 = ((int32_t)(pressure / 4) * p8) / 8192;
+            pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + p7) / 16));
+            return pressure < 30000 ? 30000 : pressure > 110000 ? 110000 : pressure;
+        }
+    };
+
+    template <> struct Formulas<Int64> : IntegerFormulas<int64_t> {
+        explicit Formulas(const bme280_calib_data &calib) : IntegerFormulas(calib) {
+            p1 = calib.dig_P1;
+            p2 = (int64_t)calib.dig_P2 * 4096;
+            p3 = calib.dig_P3;
+            p4 = (int64_t)calib.dig_P4 * 34359738368;
+            p5 = (int64_t)calib.dig_P5 * 131072;
+            p6 = calib.dig_P6;
+            p7 = (int64_t)calib.dig_P7 * 16;
+            p8 = calib.dig_P8;
+            p9 = calib.dig_P9;
+        }
+
+        uint32_t pressure(uint32_t adc, int32_t t_fine) const {
+            int64_t var1 = (int64_t)t_fine - 128000;
+            int64_t var2 = var1 * var1 * p6 + var1 * p5 + p4;
+            var1 = ((var1 * var1 * p3) / 256) + var1 * p2;
+            var1 = (140737488355328 + var1) * p1 / 8589934592;
+            if (!var1) return 3000000; // avoid the division by zero
+
+            int64_t var4 = 1048576 - adc;
+            var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+            var1 = (p9 * (var4 / 8192) * (var4 / 8192)) / 33554432;
+            var2 = (p8 * var4) / 524288;
+            var4 = ((var4 + var1 + var2) / 256) + p7;
+            uint32_t pressure = (uint32_t)(((var4 / 2) * 100) / 128);
+            return pressure < 3000000 ? 3000000 : pressure > 11000000 ? 11000000 : pressure;
+        }
+    };
+
+    template <typename Representation, uint8_t channels = BME280_ALL> class Engine {
+        static_assert(channels && !(channels & ~BME280_ALL), "channels is a mask of BME280_PRESS, _TEMP and _HUM");
+
+      public:
+        explicit Engine(const bme280_calib_data &calib) : formulas(calib) {}
+
+        // channels not in the mask are 0, temperature is always computed for t_fine
+        Reading<Representation> compensate(const bme280_uncomp_data &raw) const {
+            Reading<Representation> reading = {};
+            int32_t t_fine;
+            reading.temperature = formulas.temperature(raw.temperature, t_fine);
+            if (channels & BME280_PRESS) reading.pressure = formulas.pressure(raw.pressure, t_fine);
+            if (channels & BME280_HUM) reading.humidity = formulas.humidity(raw.humidity, t_fine);
+            return reading;
+        }
+
+        void compensate(const bme280_uncomp_data *raw, size_t n, Reading<Representation> *readings) const {
+            for (size_t i = 0; i < n; i++) readings[i] = compensate(raw[i]);
+        }
+
+      private:
+        Formulas<Representation> formulas;
+    };
+
+    enum Variant { DOUBLE, INT32, INT64 };
+
+    typedef void (*compensate_fptr_t)(const bme280_calib_data &calib, const bme280_uncomp_data *raw, size_t n,
+                                      Values *values);
+
+    template <typename Representation, uint8_t channels>
+    void compensateValues(const bme280_calib_data &calib, const bme280_uncomp_data *raw, size_t n, Values *values) {
+        Engine<Representation, channels> engine(calib);
+        for (size_t i = 0; i < n; i++) values[i] = toValues(engine.compensate(raw[i]));
+    }
+
+    template <typename Representation> compensate_fptr_t select(uint8_t channels) {
+        switch (channels & BME280_ALL) {
+        case BME280_PRESS: return compensateValues<Representation, BME280_PRESS>;
+        case BME280_TEMP: return compensateValues<Representation, BME280_TEMP>;
+        case BME280_PRESS | BME280_TEMP: return compensateValues<Representation, BME280_PRESS | BME280_TEMP>;
+        case BME280_HUM: return compensateValues<Representation, BME280_HUM>;
+        case BME280_PRESS | BME280_HUM: return compensateValues<Representation, BME280_PRESS | BME280_HUM>;
+        case BME280_TEMP | BME280_HUM: return compensateValues<Representation, BME280_TEMP | BME280_HUM>;
+        case BME280_ALL: return compensateValues<Representation, BME280_ALL>;
+        default: return NULL;
+        }
+    }
+
+    // NULL for an empty channel mask
+    inline compensate_fptr_t select(Variant variant, uint8_t channels) {
+        switch (variant) {
+        case DOUBLE: return select<Double>(channels);
+        case INT32: return select<Int32>(channels);
+        case INT64: return select<Int64>(channels);
+        default: return NULL;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,319 @@
+/*
+  Accuracy of the compensation representations over the raw input space,
+  and which of them meet the reporting resolution. The time per sample is
+  measured on the host and does not carry over to the ESP32, which has no
+  double precision FPU, so no variant is picked here.
+
+  For each calibration blob, compensates
+    every raw temperature between -40 and 85 °C,
+    every raw pressure between 300 and 1100 hPa and
+    every raw humidity between 0 and 100 % RH
+  at a number of temperatures spread over that range, with each engine, and
+  compares the results to the data sheet formulas evaluated in long double
+  without the integer truncation of t_fine. The engines give the results of
+  bme280.c built in the matching flavour, see engines.cpp.
+
+  A blob is the 26 bytes from 0x88 and the 7 bytes from 0xE1 in hex, one per
+  line of the file given with -f, as dumped from the registers of a sensor.
+
+  compile like this: g++ -O3 accuracy.cpp -I .. -I ../../bme280 -o accuracy
+  usage: ./accuracy [-f blobs] [-t temperatures]
+*/
+#include "bme280_compensation.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+using namespace BME280Compensation;
+
+#define BLOB_LEN (BME280_TEMP_PRESS_CALIB_DATA_LEN + BME280_HUMIDITY_CALIB_DATA_LEN)
+
+// the chips of engines.cpp, the first one is the default of the simulator
+static const char *default_blobs[] = {
+    "70 6b 43 67 18 fc 7d 8e 43 d6 d0 0b 27 0b 8c 00 f9 ff 8c 3c f8 c6 70 17 00 4b 6a 01 00 14 24 03 1e",
+    "45 6f 6f 68 32 00 eb 94 80 d6 d0 0b d7 1e 58 ff f9 ff ac 26 0a d8 bd 10 00 4b 67 01 00 15 20 03 1e",
+    "3f 6d 3f 67 32 00 ba 8e 93 d6 d0 0b 89 1a d1 ff f9 ff ac 26 0a d8 bd 10 00 4b 72 01 00 12 2d 03 1e",
+};
+
+// what the firmware reports: 0.01 °C, 10 Pa (Sensor::getPressure) and 0.1 % RH
+static const double resolution[] = { 0.01, 10, 0.1 };
+static const char *channel_names[] = { "temperature", "pressure", "humidity" };
+static const char *units[] = { "°C", "Pa", "% RH" };
+enum Channel { TEMPERATURE, PRESSURE, HUMIDITY, CHANNEL_COUNT };
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static bool parseBlob(const char *text, bme280_calib_data *calib) {
+    uint8_t blob[BLOB_LEN];
+    for (size_t i = 0; i < BLOB_LEN; i++) {
+        char *end;
+        unsigned long value = strtoul(text, &end, 16);
+        if (end == text || value > 0xFF) return false;
+        blob[i] = (uint8_t)value;
+        text = end;
+    }
+
+    // as parse_temp_press_calib_data and parse_humidity_calib_data of the driver
+    const uint8_t *tp = blob;
+    const uint8_t *h = blob + BME280_TEMP_PRESS_CALIB_DATA_LEN;
+    memset(calib, 0, sizeof(*calib));
+    calib->dig_T1 = BME280_CONCAT_BYTES(tp[1], tp[0]);
+    calib->dig_T2 = (int16_t)BME280_CONCAT_BYTES(tp[3], tp[2]);
+    calib->dig_T3 = (int16_t)BME280_CONCAT_BYTES(tp[5], tp[4]);
+    calib->dig_P1 = BME280_CONCAT_BYTES(tp[7], tp[6]);
+    calib->dig_P2 = (int16_t)BME280_CONCAT_BYTES(tp[9], tp[8]);
+    calib->dig_P3 = (int16_t)BME280_CONCAT_BYTES(tp[11], tp[10]);
+    calib->dig_P4 = (int16_t)BME280_CONCAT_BYTES(tp[13], tp[12]);
+    calib->dig_P5 = (int16_t)BME280_CONCAT_BYTES(tp[15], tp[14]);
+    calib->dig_P6 = (int16_t)BME280_CONCAT_BYTES(tp[17], tp[16]);
+    calib->dig_P7 = (int16_t)BME280_CONCAT_BYTES(tp[19], tp[18]);
+    calib->dig_P8 = (int16_t)BME280_CONCAT_BYTES(tp[21], tp[20]);
+    calib->dig_P9 = (int16_t)BME280_CONCAT_BYTES(tp[23], tp[22]);
+    calib->dig_H1 = tp[25];
+    calib->dig_H2 = (int16_t)BME280_CONCAT_BYTES(h[1], h[0]);
+    calib->dig_H3 = h[2];
+    calib->dig_H4 = (int16_t)((int8_t)h[3] * 16) | (int16_t)(h[4] & 0x0F);
+    calib->dig_H5 = (int16_t)((int8_t)h[5] * 16) | (int16_t)(h[4] >> 4);
+    calib->dig_H6 = (int8_t)h[6];
+    return true;
+}
+
+// The double formulas of the data sheet in long double, t_fine is not truncated
+// and nothing is clamped.
+struct Reference {
+    const bme280_calib_data &c;
+
+    long double tFine(uint32_t adc) const {
+        long double var1 = (adc / 16384.0L - c.dig_T1 / 1024.0L) * c.dig_T2;
+        long double var2 = adc / 131072.0L - c.dig_T1 / 8192.0L;
+        return var1 + var2 * var2 * c.dig_T3;
+    }
+
+    long double temperature(long double t_fine) const {
+        return t_fine / 5120.0L;
+    }
+
+    long double pressure(uint32_t adc, long double t_fine) const {
+        long double var1 = t_fine / 2.0L - 64000.0L;
+        long double var2 = var1 * var1 * c.dig_P6 / 32768.0L;
+        var2 = var2 + var1 * c.dig_P5 * 2.0L;
+        var2 = var2 / 4.0L + c.dig_P4 * 65536.0L;
+        var1 = (c.dig_P3 * var1 * var1 / 524288.0L + c.dig_P2 * var1) / 524288.0L;
+        var1 = (1.0L + var1 / 32768.0L) * c.dig_P1;
+        long double pressure = 1048576.0L - adc;
+        pressure = (pressure - var2 / 4096.0L) * 6250.0L / var1;
+        var1 = c.dig_P9 * pressure * pressure / 2147483648.0L;
+        var2 = pressure * c.dig_P8 / 32768.0L;
+        return pressure + (var1 + var2 + c.dig_P7) / 16.0L;
+    }
+
+    long double humidity(uint32_t adc, long double t_fine) const {
+        long double var1 = t_fine - 76800.0L;
+        long double var2 = c.dig_H4 * 64.0L + c.dig_H5 / 16384.0L * var1;
+        long double var3 = adc - var2;
+        long double var4 = c.dig_H2 / 65536.0L;
+        long double var5 = 1.0L + c.dig_H3 / 67108864.0L * var1;
+        long double var6 = 1.0L + c.dig_H6 / 67108864.0L * var1 * var5;
+        var6 = var3 * var4 * (var5 * var6);
+        return var6 * (1.0L - c.dig_H1 * var6 / 524288.0L);
+    }
+};
+
+// raw readings of one channel with the reference value of that channel
+struct Sweep {
+    std::vector<bme280_uncomp_data> raw;
+    std::vector<double> reference;
+};
+
+struct Sweeps {
+    Sweep channel[CHANNEL_COUNT];
+};
+
+static void sweep(const bme280_calib_data &calib, int temperatures, Sweeps &sweeps) {
+    Reference reference = { calib };
+
+    std::vector<uint32_t> in_range;
+    for (uint32_t adc = 0; adc < (1 << 20); adc++) {
+        long double temperature = reference.temperature(reference.tFine(adc));
+        if (temperature < -40 || temperature > 85) continue;
+
+        in_range.push_back(adc);
+        sweeps.channel[TEMPERATURE].raw.push_back({ 0, adc, 0 });
+        sweeps.channel[TEMPERATURE].reference.push_back((double)temperature);
+    }
+
+    for (int i = 0; i < temperatures; i++) {
+        uint32_t adc_t = in_range[(in_range.size() - 1) * i / (temperatures > 1 ? temperatures - 1 : 1)];
+        long double t_fine = reference.tFine(adc_t);
+
+        for (uint32_t adc = 0; adc < (1 << 20); adc++) {
+            long double pressure = reference.pressure(adc, t_fine);
+            if (pressure < 30000 || pressure > 110000) continue;
+            sweeps.channel[PRESSURE].raw.push_back({ adc, adc_t, 0 });
+            sweeps.channel[PRESSURE].reference.push_back((double)pressure);
+        }
+        for (uint32_t adc = 0; adc < (1 << 16); adc++) {
+            long double humidity = reference.humidity(adc, t_fine);
+            if (humidity < 0 || humidity > 100) continue;
+            sweeps.channel[HUMIDITY].raw.push_back({ 0, adc_t, adc });
+            sweeps.channel[HUMIDITY].reference.push_back((double)humidity);
+        }
+    }
+}
+
+struct Error {
+    double max;
+    double sum;
+    size_t samples;
+    double seconds;
+};
+
+struct VariantResult {
+    Error channel[CHANNEL_COUNT];
+    double all_seconds; // every sample of the pressure sweep with all channels
+    size_t all_samples;
+};
+
+template <typename Representation, uint8_t mask>
+static void measure(const bme280_calib_data &calib, const Sweep &sweep, Channel channel, Error &error) {
+    std::vector<Reading<Representation>> readings(sweep.raw.size());
+    double start = seconds();
+    Engine<Representation, mask> engine(calib);
+    engine.compensate(sweep.raw.data(), sweep.raw.size(), readings.data());
+    error.seconds += seconds() - start;
+
+    for (size_t i = 0; i < readings.size(); i++) {
+        Values values = toValues(readings[i]);
+        double value = channel == TEMPERATURE ? values.temperature
+                     : channel == PRESSURE    ? values.pressure
+                                              : values.humidity;
+        double difference = fabs(value - sweep.reference[i]);
+        if (difference > error.max) error.max = difference;
+        error.sum += difference;
+    }
+    error.samples += readings.size();
+}
+
+template <typename Representation>
+static void measure(const bme280_calib_data &calib, Sweeps &sweeps, VariantResult &result) {
+    measure<Representation, BME280_TEMP>(calib, sweeps.channel[TEMPERATURE], TEMPERATURE,
+                                         result.channel[TEMPERATURE]);
+    measure<Representation, BME280_TEMP | BME280_PRESS>(calib, sweeps.channel[PRESSURE], PRESSURE,
+                                                        result.channel[PRESSURE]);
+    measure<Representation, BME280_TEMP | BME280_HUM>(calib, sweeps.channel[HUMIDITY], HUMIDITY,
+                                                      result.channel[HUMIDITY]);
+
+    // the cost of a complete reading, with the raw humidities of the humidity sweep
+    std::vector<bme280_uncomp_data> raw = sweeps.channel[PRESSURE].raw;
+    const std::vector<bme280_uncomp_data> &humidity = sweeps.channel[HUMIDITY].raw;
+    for (size_t i = 0; i < raw.size() && !humidity.empty(); i++) raw[i].humidity = humidity[i % humidity.size()].humidity;
+    std::vector<Reading<Representation>> readings(raw.size());
+    double start = seconds();
+    Engine<Representation, BME280_ALL> engine(calib);
+    engine.compensate(raw.data(), raw.size(), readings.data());
+    result.all_seconds += seconds() - start;
+    result.all_samples += raw.size();
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "usage: %s [-f blobs] [-t temperatures]\n", program);
+    exit(2);
+}
+
+int main(int argc, char **argv) {
+    const char *file = NULL;
+    int temperatures = 9;
+
+    int option;
+    while ((option = getopt(argc, argv, "f:t:")) != -1) {
+        switch (option) {
+        case 'f': file = optarg; break;
+        case 't': temperatures = atoi(optarg); break;
+        default: usage(argv[0]);
+        }
+    }
+    if (temperatures < 1) usage(argv[0]);
+
+    std::vector<bme280_calib_data> calibrations;
+    if (file) {
+        FILE *blobs = fopen(file, "r");
+        if (!blobs) {
+            perror(file);
+            return 2;
+        }
+        char line[256];
+        while (fgets(line, sizeof(line), blobs)) {
+            if (line[0] == '#' || line[strspn(line, " \t\r\n")] == 0) continue;
+            bme280_calib_data calib;
+            if (!parseBlob(line, &calib)) {
+                fprintf(stderr, "%s: not a calibration blob: %s", file, line);
+                return 2;
+            }
+            calibrations.push_back(calib);
+        }
+        fclose(blobs);
+    } else {
+        for (const char *blob : default_blobs) {
+            bme280_calib_data calib;
+            parseBlob(blob, &calib);
+            calibrations.push_back(calib);
+        }
+    }
+
+    const char *variant_names[] = { "double", "int32", "int64" };
+    VariantResult results[3] = {};
+    size_t samples[CHANNEL_COUNT] = {};
+    for (const bme280_calib_data &calib : calibrations) {
+        Sweeps sweeps;
+        sweep(calib, temperatures, sweeps);
+        for (int c = 0; c < CHANNEL_COUNT; c++) samples[c] += sweeps.channel[c].raw.size();
+
+        measure<Double>(calib, sweeps, results[DOUBLE]);
+        measure<Int32>(calib, sweeps, results[INT32]);
+        measure<Int64>(calib, sweeps, results[INT64]);
+    }
+
+    printf("%zu calibrations, %d temperatures for pressure and humidity\n", calibrations.size(), temperatures);
+    for (int c = 0; c < CHANNEL_COUNT; c++)
+        printf("  %-12s %10zu samples, resolution %g %s\n", channel_names[c], samples[c], resolution[c], units[c]);
+
+    // The timings are of this host. The ESP32 has no double precision FPU and
+    // no 64 bit divide, so they do not rank the variants for the device.
+    printf("\nerror to the long double reference, time per sample on this host\n");
+    printf("%-8s %-12s %12s %12s %12s %6s\n", "variant", "channel", "max", "mean", "host ns", "meets");
+    std::vector<const char *> meeting;
+    for (int v = 0; v < 3; v++) {
+        bool meets = true;
+        for (int c = 0; c < CHANNEL_COUNT; c++) {
+            const Error &error = results[v].channel[c];
+            bool ok = error.max <= resolution[c];
+            meets &= ok;
+            printf("%-8s %-12s %12.6f %12.6f %12.2f %6s\n", variant_names[v], channel_names[c], error.max,
+                   error.sum / error.samples, error.seconds * 1e9 / error.samples, ok ? "yes" : "no");
+        }
+
+        double all_ns = results[v].all_seconds * 1e9 / results[v].all_samples;
+        printf("%-8s %-12s %12s %12s %12.2f %6s\n", variant_names[v], "all", "", "", all_ns, meets ? "yes" : "no");
+        if (meets) meeting.push_back(variant_names[v]);
+    }
+
+    if (meeting.empty()) {
+        printf("\nno variant meets the resolution\n");
+        return 1;
+    }
+
+    printf("\nvariants that meet the resolution:");
+    for (const char *name : meeting) printf(" %s", name);
+    printf("\nhost timings only, compare their cost on the device before choosing one\n");
+    return 0;
+}
@@ -0,0 +1,180 @@
+/*
+  Compares the compensation engines of every representation and channel mask
+  in one program.
+
+  First checks that the engine of the representation the driver was built for
+  gives bit for bit the results of bme280_compensate_data, over every raw
+  temperature between -40 and 85 °C with random raw pressure and humidity.
+  Then compensates readings around room conditions with every engine and
+  reports the time per sample and the difference to the double engine.
+
+  compile like this: g++ -O3 engines.cpp ../../bme280/bme280.c -I .. -I ../../bme280 -I ../../../test -o engines
+  add -DBME280_64BIT_ENABLE or -DBME280_FLOAT_ENABLE to check the other representations against the driver
+  usage: ./engines [samples]
+*/
+#include "bme280_compensation.h"
+#include "bme280.h"
+#include "bme280_fixture.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+using namespace BME280Compensation;
+
+#ifdef BME280_FLOAT_ENABLE
+typedef Double Driver;
+#define DRIVER "double"
+#elif defined(BME280_64BIT_ENABLE)
+typedef Int64 Driver;
+#define DRIVER "int64"
+#else
+typedef Int32 Driver;
+#define DRIVER "int32"
+#endif
+
+static const uint8_t channels[] = { BME280_TEMP, BME280_TEMP | BME280_PRESS, BME280_TEMP | BME280_HUM, BME280_ALL };
+static const char *channel_names[] = { "temp", "temp, pressure", "temp, humidity", "all" };
+#define CHANNELS (sizeof(channels) / sizeof(channels[0]))
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+template <uint8_t mask> static size_t check(const bme280_calib_data &calib, const std::vector<bme280_uncomp_data> &raw) {
+    Engine<Driver, mask> engine(calib);
+    bme280_calib_data driver_calib = calib;
+    size_t count = 0;
+    for (const bme280_uncomp_data &sample : raw) {
+        bme280_data expected = {};
+        bme280_compensate_data(mask, &sample, &expected, &driver_calib);
+        Reading<Driver> actual = engine.compensate(sample);
+
+        bool same = !memcmp(&expected.temperature, &actual.temperature, sizeof(actual.temperature));
+        if (mask & BME280_PRESS) same &= !memcmp(&expected.pressure, &actual.pressure, sizeof(actual.pressure));
+        if (mask & BME280_HUM) same &= !memcmp(&expected.humidity, &actual.humidity, sizeof(actual.humidity));
+        if (!same && count++ < 5) {
+            printf("  raw %u %u %u: driver %.6f %.6f %.6f, engine %.6f %.6f %.6f\n", sample.pressure,
+                   sample.temperature, sample.humidity, (double)expected.pressure, (double)expected.temperature,
+                   (double)expected.humidity, (double)actual.pressure, (double)actual.temperature,
+                   (double)actual.humidity);
+        }
+    }
+    return count;
+}
+
+static size_t check(const bme280_calib_data &calib) {
+    // raw temperatures from the lowest one that compensates above -40 °C to the highest one below 85 °C
+    Engine<Double, BME280_TEMP> temperature(calib);
+    std::vector<bme280_uncomp_data> raw;
+    for (uint32_t adc = 0; adc < (1 << 20); adc++) {
+        bme280_uncomp_data sample = { next_random() >> 12, adc, next_random() >> 16 };
+        double value = temperature.compensate(sample).temperature;
+        if (value > -40 && value < 85) raw.push_back(sample);
+    }
+
+    size_t failures = check<BME280_TEMP>(calib, raw) + check<BME280_TEMP | BME280_PRESS>(calib, raw) +
+                      check<BME280_TEMP | BME280_HUM>(calib, raw) + check<BME280_ALL>(calib, raw);
+    printf("  %zu raw temperatures, each channel mask: %zu mismatches\n", raw.size(), failures);
+    return failures;
+}
+
+struct Timing {
+    double engine;   // ns per sample of Engine::compensate
+    double selected; // ns per sample through the function pointer of select()
+};
+
+template <typename Representation, uint8_t mask>
+static double time_engine(const bme280_calib_data &calib, const std::vector<bme280_uncomp_data> &raw,
+                          std::vector<Reading<Representation>> &readings) {
+    double start = seconds();
+    Engine<Representation, mask> engine(calib);
+    engine.compensate(raw.data(), raw.size(), readings.data());
+    return (seconds() - start) * 1e9 / raw.size();
+}
+
+template <typename Representation>
+static Timing time_channels(size_t c, const bme280_calib_data &calib, const std::vector<bme280_uncomp_data> &raw) {
+    std::vector<Reading<Representation>> readings(raw.size());
+    Timing timing;
+    switch (c) {
+    case 0: timing.engine = time_engine<Representation, BME280_TEMP>(calib, raw, readings); break;
+    case 1: timing.engine = time_engine<Representation, BME280_TEMP | BME280_PRESS>(calib, raw, readings); break;
+    case 2: timing.engine = time_engine<Representation, BME280_TEMP | BME280_HUM>(calib, raw, readings); break;
+    default: timing.engine = time_engine<Representation, BME280_ALL>(calib, raw, readings); break;
+    }
+    return timing;
+}
+
+static void benchmark(size_t n) {
+    const bme280_calib_data &calib = calibrations[0];
+    std::vector<bme280_uncomp_data> raw(n);
+    for (bme280_uncomp_data &sample : raw) {
+        sample.temperature = 512000 + next_random() % 24000;
+        sample.pressure = 390000 + next_random() % 40000; // 95..105 kPa
+        sample.humidity = 23000 + next_random() % 10000;
+    }
+
+    const Variant variants[] = { DOUBLE, INT32, INT64 };
+    const char *variant_names[] = { "double", "int32", "int64" };
+    std::vector<Values> reference(n), values(n);
+    select(DOUBLE, BME280_ALL)(calib, raw.data(), n, reference.data());
+
+    printf("\n%zu samples around room conditions, difference to double as max / mean\n", n);
+    printf("%-8s %-16s %8s %8s %17s %17s %17s\n", "variant", "channels", "ns", "ns sel", "°C", "Pa", "% RH");
+    for (size_t v = 0; v < sizeof(variants) / sizeof(variants[0]); v++) {
+        for (size_t c = 0; c < CHANNELS; c++) {
+            Timing timing = variants[v] == DOUBLE ? time_channels<Double>(c, calib, raw)
+                          : variants[v] == INT32  ? time_channels<Int32>(c, calib, raw)
+                                                  : time_channels<Int64>(c, calib, raw);
+            compensate_fptr_t compensate = select(variants[v], channels[c]);
+            double start = seconds();
+            compensate(calib, raw.data(), n, values.data());
+            timing.selected = (seconds() - start) * 1e9 / n;
+
+            double max[3] = {}, sum[3] = {};
+            for (size_t i = 0; i < n; i++) {
+                double error[3] = { fabs(values[i].temperature - reference[i].temperature),
+                                    fabs(values[i].pressure - reference[i].pressure),
+                                    fabs(values[i].humidity - reference[i].humidity) };
+                for (int k = 0; k < 3; k++) {
+                    if (error[k] > max[k]) max[k] = error[k];
+                    sum[k] += error[k];
+                }
+            }
+
+            char columns[3][32];
+            const uint8_t needed[3] = { BME280_TEMP, BME280_PRESS, BME280_HUM };
+            for (int k = 0; k < 3; k++) {
+                if (channels[c] & needed[k])
+                    snprintf(columns[k], sizeof(columns[k]), "%.4f / %.4f", max[k], sum[k] / n);
+                else
+                    snprintf(columns[k], sizeof(columns[k]), "-");
+            }
+            printf("%-8s %-16s %8.2f %8.2f %17s %17s %17s\n", variant_names[v], channel_names[c], timing.engine,
+                   timing.selected, columns[0], columns[1], columns[2]);
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], NULL, 0) : 1 << 22;
+    size_t failures = 0;
+
+    printf("engine " DRIVER " against the driver\n");
+    for (size_t i = 0; i < CALIBRATIONS; i++) {
+        printf("calibration %zu\n", i + 1);
+        failures += check(calibrations[i]);
+    }
+
+    if (n) benchmark(n);
+
+    if (failures) printf("\n%zu mismatches\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,474 @@
+#include "bme280_sim.h"
+
+#include <string.h>
+
+#define REG_CALIB_TEMP_PRESS 0x88
+#define REG_CHIP_ID          0xD0
+#define REG_RESET            0xE0
+#define REG_CALIB_HUMIDITY   0xE1
+#define REG_CALIB_CRC        0xE8
+#define REG_CTRL_HUM         0xF2
+#define REG_STATUS           0xF3
+#define REG_CTRL_MEAS        0xF4
+#define REG_CONFIG           0xF5
+#define REG_DATA             0xF7
+
+#define SOFT_RESET_COMMAND 0xB6
+#define STATUS_MEASURING   0x08
+#define STATUS_IM_UPDATE   0x01
+
+#define STARTUP_TIME_NS 2000000ULL
+
+#define DEFAULT_CLOCK_SPEED_HZ 100000
+
+// calibration of a real chip, used unless setCalibration is called
+static uint8_t calib_temp_press[BME280_TEMP_PRESS_CALIB_DATA_LEN] = {
+    0x70, 0x6B, 0x43, 0x67, 0x18, 0xFC, // T1 .. T3
+    0x7D, 0x8E, 0x43, 0xD6, 0xD0, 0x0B, // P1 .. P3
+    0x27, 0x0B, 0x8C, 0x00, 0xF9, 0xFF, // P4 .. P6
+    0x8C, 0x3C, 0xF8, 0xC6, 0x70, 0x17, // P7 .. P9
+    0x00, 0x4B                          // reserved, H1
+};
+static uint8_t calib_humidity[BME280_HUMIDITY_CALIB_DATA_LEN] = {
+    0x6A, 0x01, 0x00, 0x14, 0x24, 0x03, 0x1E // H2 .. H6
+};
+
+enum BusState { BUS_IDLE, BUS_ADDRESS, BUS_REGISTER, BUS_DATA, BUS_READING, BUS_IGNORED };
+
+static uint8_t regs[256];
+static uint8_t address = BME280_I2C_ADDR_PRIM;
+static uint32_t clock_speed_hz = DEFAULT_CLOCK_SPEED_HZ;
+
+static uint64_t now_ns;
+static uint64_t bus_time_ns;
+static uint64_t delay_time_ns;
+static uint32_t transactions;
+static uint32_t bytes;
+
+static BusState bus_state;
+static bool in_transaction;
+static uint8_t reg_pointer;
+
+static uint64_t ready_at_ns;
+static bool measuring;
+static uint64_t meas_start_ns;
+static uint64_t meas_end_ns;
+static uint8_t osr_h_active;
+
+static bool filter_valid;
+static double filtered_temperature;
+static double filtered_pressure;
+
+static BME280Sim::Environment defaultEnvironment(uint64_t) {
+    BME280Sim::Environment environment = { 21.5, 45.0, 101325.0 };
+    return environment;
+}
+
+static BME280Sim::environment_fptr_t environment = defaultEnvironment;
+
+// the same polynomial and procedure as bme280_crc_selftest, without clobbering the input
+static uint8_t crc(const uint8_t *data, uint8_t len) {
+    uint8_t crc_reg = 0xFF;
+    for (uint8_t i = 0; i < len; i++) {
+        uint8_t value = data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            bool din = ((crc_reg & 0x80) != 0) ^ ((value & 0x80) != 0);
+            crc_reg = (crc_reg << 1) ^ (din ? 0x1D : 0x00);
+            value <<= 1;
+        }
+    }
+
+    return crc_reg ^ 0xFF;
+}
+
+static void loadCalibration() {
+    uint8_t blob[BME280_TEMP_PRESS_CALIB_DATA_LEN + BME280_HUMIDITY_CALIB_DATA_LEN];
+    memcpy(blob, calib_temp_press, BME280_TEMP_PRESS_CALIB_DATA_LEN);
+    memcpy(blob + BME280_TEMP_PRESS_CALIB_DATA_LEN, calib_humidity, BME280_HUMIDITY_CALIB_DATA_LEN);
+
+    memcpy(&regs[REG_CALIB_TEMP_PRESS], calib_temp_press, BME280_TEMP_PRESS_CALIB_DATA_LEN);
+    memcpy(&regs[REG_CALIB_HUMIDITY], calib_humidity, BME280_HUMIDITY_CALIB_DATA_LEN);
+    regs[REG_CALIB_CRC] = crc(blob, sizeof(blob));
+}
+
+static void resetRegisters() {
+    memset(regs, 0, sizeof(regs));
+    regs[REG_CHIP_ID] = BME280_CHIP_ID;
+    loadCalibration();
+
+    // data registers start out with the "skipped" value
+    regs[REG_DATA + 0] = 0x80;
+    regs[REG_DATA + 3] = 0x80;
+    regs[REG_DATA + 6] = 0x80;
+
+    measuring = false;
+    filter_valid = false;
+    osr_h_active = 0;
+    ready_at_ns = now_ns + STARTUP_TIME_NS;
+}
+
+// number of samples taken for an oversampling register value
+static uint32_t samples(uint8_t osr) {
+    return osr == 0 ? 0 : (osr >= 5 ? 16 : 1 << (osr - 1));
+}
+
+static uint64_t measurementTimeNs() {
+    uint32_t t = samples((regs[REG_CTRL_MEAS] >> 5) & 0x07);
+    uint32_t p = samples((regs[REG_CTRL_MEAS] >> 2) & 0x07);
+    uint32_t h = samples(osr_h_active);
+
+    uint64_t time = 1000000ULL + 2000000ULL * t;
+    if (p) time += 2000000ULL * p + 500000ULL;
+    if (h) time += 2000000ULL * h + 500000ULL;
+    return time;
+}
+
+static uint64_t standbyTimeNs() {
+    static const uint64_t standby_us[] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+    return standby_us[(regs[REG_CONFIG] >> 5) & 0x07] * 1000ULL;
+}
+
+static void parseCalibration(struct bme280_calib_data *calib) {
+    const uint8_t *tp = &regs[REG_CALIB_TEMP_PRESS];
+    const uint8_t *h = &regs[REG_CALIB_HUMIDITY];
+
+    calib->dig_T1 = BME280_CONCAT_BYTES(tp[1], tp[0]);
+    calib->dig_T2 = (int16_t)BME280_CONCAT_BYTES(tp[3], tp[2]);
+    calib->dig_T3 = (int16_t)BME280_CONCAT_BYTES(tp[5], tp[4]);
+    calib->dig_P1 = BME280_CONCAT_BYTES(tp[7], tp[6]);
+    calib->dig_P2 = (int16_t)BME280_CONCAT_BYTES(tp[9], tp[8]);
+    calib->dig_P3 = (int16_t)BME280_CONCAT_BYTES(tp[11], tp[10]);
+    calib->dig_P4 = (int16_t)BME280_CONCAT_BYTES(tp[13], tp[12]);
+    calib->dig_P5 = (int16_t)BME280_CONCAT_BYTES(tp[15], tp[14]);
+    calib->dig_P6 = (int16_t)BME280_CONCAT_BYTES(tp[17], tp[16]);
+    calib->dig_P7 = (int16_t)BME280_CONCAT_BYTES(tp[19], tp[18]);
+    calib->dig_P8 = (int16_t)BME280_CONCAT_BYTES(tp[21], tp[20]);
+    calib->dig_P9 = (int16_t)BME280_CONCAT_BYTES(tp[23], tp[22]);
+    calib->dig_H1 = tp[25];
+    calib->dig_H2 = (int16_t)BME280_CONCAT_BYTES(h[1], h[0]);
+    calib->dig_H3 = h[2];
+    calib->dig_H4 = (int16_t)((int8_t)h[3] * 16) | (int16_t)(h[4] & 0x0F);
+    calib->dig_H5 = (int16_t)((int8_t)h[5] * 16) | (int16_t)(h[4] >> 4);
+    calib->dig_H6 = (int8_t)h[6];
+}
+
+// Compensation formulas of the data sheet (double precision variant), used to find the
+// raw ADC value that corresponds to a physical value.
+
+static double temperatureOf(uint32_t adc, const struct bme280_calib_data *c, double) {
+    double var1 = ((double)adc / 16384.0 - (double)c->dig_T1 / 1024.0) * (double)c->dig_T2;
+    double var2 = (double)adc / 131072.0 - (double)c->dig_T1 / 8192.0;
+    var2 = var2 * var2 * (double)c->dig_T3;
+    return (var1 + var2) / 5120.0;
+}
+
+static double tFineOf(uint32_t adc, const struct bme280_calib_data *c) {
+    return temperatureOf(adc, c, 0) * 5120.0;
+}
+
+static double pressureOf(uint32_t adc, const struct bme280_calib_data *c, double t_fine) {
+    double var1 = t_fine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * (double)c->dig_P6 / 32768.0;
+    var2 = var2 + var1 * (double)c->dig_P5 * 2.0;
+    var2 = var2 / 4.0 + (double)c->dig_P4 * 65536.0;
+    double var3 = (double)c->dig_P3 * var1 * var1 / 524288.0;
+    var1 = (var3 + (double)c->dig_P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * (double)c->dig_P1;
+    if (var1 == 0) return 0;
+
+    double pressure = 1048576.0 - (double)adc;
+    pressure = (pressure - var2 / 4096.0) * 6250.0 / var1;
+    var1 = (double)c->dig_P9 * pressure * pressure / 2147483648.0;
+    var2 = pressure * (double)c->dig_P8 / 32768.0;
+    return pressure + (var1 + var2 + (double)c->dig_P7) / 16.0;
+}
+
+static double humidityOf(uint32_t adc, const struct bme280_calib_data *c, double t_fine) {
+    double var1 = t_fine - 76800.0;
+    double var2 = (double)c->dig_H4 * 64.0 + ((double)c->dig_H5 / 16384.0) * var1;
+    double var3 = adc - var2;
+    double var4 = (double)c->dig_H2 / 65536.0;
+    double var5 = 1.0 + ((double)c->dig_H3 / 67108864.0) * var1;
+    double var6 = 1.0 + ((double)c->dig_H6 / 67108864.0) * var1 * var5;
+    var6 = var3 * var4 * (var5 * var6);
+    return var6 * (1.0 - (double)c->dig_H1 * var6 / 524288.0);
+}
+
+typedef double (*compensation_fptr_t)(uint32_t adc, const struct bme280_calib_data *c, double t_fine);
+
+// binary search for the ADC value whose compensated value is closest to the target
+static uint32_t adcFor(compensation_fptr_t f, double target, uint32_t max,
+                       const struct bme280_calib_data *c, double t_fine) {
+    bool increasing = f(max, c, t_fine) > f(0, c, t_fine);
+    uint32_t low = 0;
+    uint32_t high = max;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if ((f(mid, c, t_fine) < target) == increasing) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    return low;
+}
+
+// data sheet: resolution is 16 bit at 1x oversampling, one more bit per doubling,
+// 20 bit whenever the IIR filter is enabled
+static uint32_t quantize(double adc, uint8_t osr, bool filtered) {
+    uint32_t value = (uint32_t)(adc + 0.5);
+    if (filtered || osr >= 5) return value;
+    return value & ~((1U << (5 - osr)) - 1);
+}
+
+static void latchMeasurement(uint64_t time_ns) {
+    struct bme280_calib_data calib;
+    parseCalibration(&calib);
+    BME280Sim::Environment env = environment(time_ns / 1000);
+
+    uint8_t osr_t = (regs[REG_CTRL_MEAS] >> 5) & 0x07;
+    uint8_t osr_p = (regs[REG_CTRL_MEAS] >> 2) & 0x07;
+    uint8_t filter = (regs[REG_CONFIG] >> 2) & 0x07;
+    uint32_t coefficient = filter == 0 ? 1 : (filter >= 4 ? 16 : 1 << filter);
+
+    uint32_t adc_t = adcFor(temperatureOf, env.temperature, 0xFFFFF, &calib, 0);
+    double t_fine = tFineOf(adc_t, &calib);
+    uint32_t adc_p = adcFor(pressureOf, env.pressure, 0xFFFFF, &calib, t_fine);
+    uint32_t adc_h = adcFor(humidityOf, env.humidity, 0xFFFF, &calib, t_fine);
+
+    if (!filter_valid || coefficient == 1) {
+        filtered_temperature = adc_t;
+        filtered_pressure = adc_p;
+        filter_valid = true;
+    } else {
+        filtered_temperature = (filtered_temperature * (coefficient - 1) + adc_t) / coefficient;
+        filtered_pressure = (filtered_pressure * (coefficient - 1) + adc_p) / coefficient;
+    }
+
+    uint32_t out_t = osr_t ? quantize(filtered_temperature, osr_t, coefficient > 1) : 0x80000;
+    uint32_t out_p = osr_p ? quantize(filtered_pressure, osr_p, coefficient > 1) : 0x80000;
+    uint32_t out_h = osr_h_active ? adc_h : 0x8000;
+
+    uint8_t *data = &regs[REG_DATA];
+    data[0] = out_p >> 12;
+    data[1] = out_p >> 4;
+    data[2] = (out_p << 4) & 0xF0;
+    data[3] = out_t >> 12;
+    data[4] = out_t >> 4;
+    data[5] = (out_t << 4) & 0xF0;
+    data[6] = out_h >> 8;
+    data[7] = out_h;
+}
+
+static void startMeasurement(uint64_t time_ns) {
+    measuring = true;
+    meas_start_ns = time_ns;
+    meas_end_ns = time_ns + measurementTimeNs();
+}
+
+// catches up with conversions that finished since the last bus access
+static void update() {
+    while (measuring && now_ns >= meas_end_ns) {
+        if ((regs[REG_CTRL_MEAS] & 0x03) != BME280_NORMAL_MODE) {
+            latchMeasurement(meas_end_ns);
+            measuring = false;
+            regs[REG_CTRL_MEAS] &= ~0x03; // back to sleep mode after a forced measurement
+            break;
+        }
+
+        uint64_t period = measurementTimeNs() + standbyTimeNs();
+        if (now_ns >= meas_end_ns + period) {
+            uint64_t skipped = (now_ns - meas_end_ns) / period;
+            meas_end_ns += skipped * period;
+        }
+        latchMeasurement(meas_end_ns);
+        startMeasurement(meas_end_ns + standbyTimeNs());
+    }
+}
+
+static uint8_t readRegister(uint8_t reg) {
+    if (reg == REG_STATUS) {
+        update();
+        uint8_t status = 0;
+        if (measuring && now_ns >= meas_start_ns) status |= STATUS_MEASURING;
+        if (now_ns < ready_at_ns) status |= STATUS_IM_UPDATE;
+        return status;
+    }
+
+    return reg == REG_RESET ? 0 : regs[reg];
+}
+
+static void writeRegister(uint8_t reg, uint8_t value) {
+    switch (reg) {
+    case REG_RESET:
+        if (value == SOFT_RESET_COMMAND) resetRegisters();
+        break;
+    case REG_CTRL_HUM:
+        regs[REG_CTRL_HUM] = value & 0x07;
+        break;
+    case REG_CTRL_MEAS:
+        update();
+        regs[REG_CTRL_MEAS] = value;
+        // data sheet: changes to ctrl_hum only become effective after writing ctrl_meas
+        osr_h_active = regs[REG_CTRL_HUM];
+        if ((value & 0x03) == BME280_SLEEP_MODE) {
+            measuring = false;
+        } else {
+            startMeasurement(now_ns);
+        }
+        break;
+    case REG_CONFIG:
+        regs[REG_CONFIG] = value & 0xFD;
+        break;
+    default:
+        break; // read only
+    }
+}
+
+static void clockBus(uint32_t bits) {
+    uint64_t duration = (uint64_t)bits * 1000000000ULL / clock_speed_hz;
+    now_ns += duration;
+    bus_time_ns += duration;
+}
+
+void BME280Sim::reset() {
+    now_ns = 0;
+    resetStats();
+    bus_state = BUS_IDLE;
+    in_transaction = false;
+    reg_pointer = 0;
+    resetRegisters();
+}
+
+void BME280Sim::setCalibration(const uint8_t *temp_press_calib, const uint8_t *humidity_calib) {
+    memcpy(calib_temp_press, temp_press_calib, BME280_TEMP_PRESS_CALIB_DATA_LEN);
+    memcpy(calib_humidity, humidity_calib, BME280_HUMIDITY_CALIB_DATA_LEN);
+    loadCalibration();
+}
+
+void BME280Sim::setEnvironment(environment_fptr_t env) {
+    environment = env ? env : defaultEnvironment;
+}
+
+void BME280Sim::setAddress(uint8_t addr) {
+    address = addr;
+}
+
+void BME280Sim::setClockSpeed(uint32_t hz) {
+    clock_speed_hz = hz;
+}
+
+uint64_t BME280Sim::now() {
+    return now_ns / 1000;
+}
+
+void BME280Sim::advance(uint64_t microseconds) {
+    now_ns += microseconds * 1000;
+}
+
+void BME280Sim::busStart() {
+    if (!in_transaction) {
+        transactions++;
+        in_transaction = true;
+        update();
+    }
+    clockBus(1);
+    bus_state = BUS_ADDRESS;
+}
+
+bool BME280Sim::busWrite(uint8_t byte) {
+    clockBus(9);
+    bytes++;
+
+    switch (bus_state) {
+    case BUS_ADDRESS:
+        if ((byte >> 1) != address) {
+            bus_state = BUS_IGNORED;
+            return false;
+        }
+        bus_state = (byte & 0x01) ? BUS_READING : BUS_REGISTER;
+        return true;
+    case BUS_REGISTER:
+        reg_pointer = byte;
+        bus_state = BUS_DATA;
+        return true;
+    case BUS_DATA:
+        // writes are (register, data) pairs, see data sheet section 6.2.1
+        writeRegister(reg_pointer, byte);
+        bus_state = BUS_REGISTER;
+        return true;
+    default:
+        return false;
+    }
+}
+
+uint8_t BME280Sim::busRead(bool) {
+    clockBus(9);
+    bytes++;
+
+    if (bus_state != BUS_READING) return 0xFF;
+    return readRegister(reg_pointer++);
+}
+
+void BME280Sim::busStop() {
+    clockBus(1);
+    in_transaction = false;
+    bus_state = BUS_IDLE;
+}
+
+int8_t BME280Sim::read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
+    busStart();
+    bool ack = busWrite(dev_id << 1) && busWrite(reg_addr);
+    busStop();
+    if (!ack) return -1;
+
+    busStart();
+    ack = busWrite((dev_id << 1) | 0x01);
+    for (uint16_t i = 0; ack && i < len; i++) {
+        reg_data[i] = busRead(i + 1 < len);
+    }
+    busStop();
+
+    return ack ? 0 : -1;
+}
+
+int8_t BME280Sim::write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
+    busStart();
+    bool ack = busWrite(dev_id << 1) && busWrite(reg_addr);
+    for (uint16_t i = 0; ack && i < len; i++) {
+        ack = busWrite(reg_data[i]);
+    }
+    busStop();
+
+    return ack ? 0 : -1;
+}
+
+void BME280Sim::delayMs(uint32_t period) {
+    now_ns += period * 1000000ULL;
+    delay_time_ns += period * 1000000ULL;
+}
+
+void BME280Sim::attach(struct bme280_dev *dev) {
+    dev->dev_id = address;
+    dev->intf = BME280_I2C_INTF;
+    dev->read = read;
+    dev->write = write;
+    dev->delay_ms = delayMs;
+}
+
+BME280Sim::Stats BME280Sim::getStats() {
+    Stats stats;
+    stats.transactions = transactions;
+    stats.bytes = bytes;
+    stats.bus_time_us = bus_time_ns / 1000;
+    stats.delay_time_us = delay_time_ns / 1000;
+    return stats;
+}
+
+void BME280Sim::resetStats() {
+    transactions = 0;
+    bytes = 0;
+    bus_time_ns = 0;
+    delay_time_ns = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef BME280_SIM_H_
+#define BME280_SIM_H_
+
+#include "bme280.h"
+
+// Register level model of a BME280 attached to an I2C bus, intended to run
+// the firmware's sensor path on a Linux host.
+//
+// The simulator keeps its own clock, which is advanced by bus activity (at the
+// configured I2C clock speed) and by calls to delayMs. Measurements take the
+// typical conversion time given in the data sheet and sample the configured
+// environment at the end of the conversion.
+namespace BME280Sim {
+    struct Environment {
+        double temperature; // °C
+        double humidity;    // % relative humidity
+        double pressure;    // Pa
+    };
+
+    // returns the conditions around the sensor at the given simulated time
+    typedef Environment (*environment_fptr_t)(uint64_t time_us);
+
+    struct Stats {
+        uint32_t transactions;  // START ... STOP frames (repeated starts do not count)
+        uint32_t bytes;         // bytes clocked over the bus, including address bytes
+        uint64_t bus_time_us;   // time the bus was busy
+        uint64_t delay_time_us; // time spent in delayMs
+    };
+
+    // power-on reset of the chip, also resets clock and statistics
+    void reset();
+    void setCalibration(const uint8_t *temp_press_calib, const uint8_t *humidity_calib);
+    void setEnvironment(environment_fptr_t environment);
+    void setAddress(uint8_t address);
+    void setClockSpeed(uint32_t hz);
+
+    uint64_t now(); // simulated time in µs
+    void advance(uint64_t microseconds);
+
+    // bus level interface, one call per condition or byte on the wire
+    void busStart();
+    bool busWrite(uint8_t byte); // returns whether the byte was acknowledged
+    uint8_t busRead(bool ack);
+    void busStop();
+
+    // callbacks to be used in struct bme280_dev
+    int8_t read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
+    int8_t write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
+    void delayMs(uint32_t period);
+    void attach(struct bme280_dev *dev);
+
+    Stats getStats();
+    void resetStats();
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+  Bus cost baseline of the firmware's sensor path, measured on the simulator.
+  Performs the same driver calls as Sensor::init, Sensor::startMeasurement and
+  Sensor::readValues, for two wakes: the first one initializes the sensor and
+  caches its calibration and settings like the RTC memory cache, the one after
+  deep sleep restores them once the calibration CRC matches.
+  compile like this: g++ baseline.cpp ../bme280_sim.cpp ../../bme280/bme280.c ../../bme280/selftest/bme280_selftest.c -I .. -I ../../bme280 -o baseline
+  usage: ./baseline [channels], a mask of BME280_PRESS (1), _TEMP (2) and _HUM (4), 6 for the firmware without
+  pressure
+*/
+#include "bme280_sim.h"
+#include "selftest/bme280_selftest.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DEEP_SLEEP_MICROSECONDS 10000000
+
+// what Sensor keeps in RTC memory
+struct Cache {
+    uint8_t calib_crc;
+    struct bme280_calib_data calib_data;
+    struct bme280_settings settings;
+};
+
+static BME280Sim::Stats previous;
+// waits with microsecond resolution like Delay::wait, which the simulator's delayMs does not count
+static uint64_t waited_us;
+
+static void wait(uint32_t microseconds) {
+    BME280Sim::advance(microseconds);
+    waited_us += microseconds;
+}
+
+static uint32_t time_us() {
+    return BME280Sim::now();
+}
+
+// the simulated bus, with the microsecond wait and clock Sensor::init sets
+static void attach(struct bme280_dev *device) {
+    BME280Sim::attach(device);
+    device->delay_us = wait;
+    device->time_us = time_us;
+}
+
+static void report(const char *phase, int8_t result) {
+    BME280Sim::Stats stats = BME280Sim::getStats();
+    stats.delay_time_us += waited_us;
+    printf("%-30s %4d %12u %7u %10llu %10llu\n", phase, result,
+           stats.transactions - previous.transactions,
+           stats.bytes - previous.bytes,
+           (unsigned long long)(stats.bus_time_us - previous.bus_time_us),
+           (unsigned long long)(stats.delay_time_us - previous.delay_time_us));
+    previous = stats;
+}
+
+static void startWake(const char *name) {
+    BME280Sim::resetStats();
+    previous = BME280Sim::Stats();
+    waited_us = 0;
+    printf("\n%s\n", name);
+    printf("%-30s %4s %12s %7s %10s %10s\n", "call", "rslt", "transactions", "bytes", "bus [us]", "delay [us]");
+}
+
+static void endWake(uint64_t started) {
+    BME280Sim::Stats total = BME280Sim::getStats();
+    printf("%-30s %4s %12u %7u %10llu %10llu\n", "total", "", total.transactions, total.bytes,
+           (unsigned long long)total.bus_time_us, (unsigned long long)(total.delay_time_us + waited_us));
+    printf("simulated time: %llu us\n", (unsigned long long)(BME280Sim::now() - started));
+}
+
+static int8_t readCalibrationCrc(uint8_t *crc, struct bme280_dev *device) {
+    return bme280_get_regs(BME280_CRC_DATA_ADDR, crc, BME280_CRC_DATA_LEN, device);
+}
+
+// Sensor::init on the first wake
+static void initialize(uint8_t channels, struct bme280_dev *device, Cache *cache) {
+    report("bme280_init", bme280_init(device));
+
+    device->settings.osr_h = channels & BME280_HUM ? BME280_OVERSAMPLING_1X : BME280_NO_OVERSAMPLING;
+    device->settings.osr_p = channels & BME280_PRESS ? BME280_OVERSAMPLING_1X : BME280_NO_OVERSAMPLING;
+    device->settings.osr_t = BME280_OVERSAMPLING_1X;
+    device->settings.filter = BME280_FILTER_COEFF_OFF;
+    report("bme280_set_sensor_settings", bme280_set_sensor_settings(
+        BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL | BME280_OSR_HUM_SEL | BME280_FILTER_SEL, device));
+
+    report("bme280_crc_selftest", bme280_crc_selftest(device));
+    report("read calibration CRC", readCalibrationCrc(&cache->calib_crc, device));
+    cache->calib_data = device->calib_data;
+    cache->settings = device->settings;
+}
+
+// Sensor::init after deep sleep, returns whether the cache could be used
+static bool restore(struct bme280_dev *device, const Cache &cache) {
+    uint8_t crc = 0;
+    int8_t result = readCalibrationCrc(&crc, device);
+    report("read calibration CRC", result);
+    if (result != BME280_OK || crc != cache.calib_crc) return false;
+
+    device->chip_id = BME280_CHIP_ID;
+    device->calib_data = cache.calib_data;
+    device->settings = cache.settings;
+    return true;
+}
+
+// Sensor::startMeasurement and Sensor::readValues
+static void measure(uint8_t channels, struct bme280_dev *device, struct bme280_data *data) {
+    report("bme280_trigger_measurement", bme280_trigger_measurement(device));
+    report("bme280_wait_for_measurement", bme280_wait_for_measurement(device));
+
+    report("bme280_fetch_measurement", bme280_fetch_measurement(channels, data, device));
+}
+
+int main(int argc, char **argv) {
+    struct bme280_dev device = {};
+    struct bme280_data data = {};
+    Cache cache = {};
+    uint8_t channels = (argc > 1 ? strtoul(argv[1], NULL, 0) : BME280_ALL) | BME280_TEMP;
+
+    BME280Sim::reset();
+    attach(&device);
+
+    startWake("first wake");
+    uint64_t started = BME280Sim::now();
+    initialize(channels, &device, &cache);
+    measure(channels, &device, &data);
+    endWake(started);
+
+    BME280Sim::advance(DEEP_SLEEP_MICROSECONDS);
+    device = bme280_dev();
+    attach(&device);
+
+    startWake("wake from deep sleep");
+    started = BME280Sim::now();
+    if (!restore(&device, cache)) {
+        printf("calibration CRC changed\n");
+        return 1;
+    }
+    measure(channels, &device, &data);
+    endWake(started);
+
+    printf("\nreading: %ld (100 * °C), %lu (Pa), %lu (1024 * %% rH)\n",
+           (long)data.temperature, (unsigned long)data.pressure, (unsigned long)data.humidity);
+
+    return 0;
+}
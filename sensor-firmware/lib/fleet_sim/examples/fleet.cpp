@@ -0,0 +1,127 @@
+/*
+  Simulates a fleet of sensors advertising to one gateway and reports the
+  delivery probability per sensor, duplicates and the gateway's packet rate.
+  Times are given in milliseconds, the defaults match the firmware.
+  compile like this: g++ -O2 fleet.cpp ../fleet_sim.cpp -I .. -o fleet
+  usage: ./fleet [-n sensors] [-h hours] [-p period] [-w window] [-s startup] [-j wake jitter]
+                 [-d drift ppm] [-P sync|random|slots] [-S slots]
+                 [-i adv interval] [-J adv interval jitter] [-l adv data length]
+                 [-I scan interval] [-W scan window] [-L loss] [-r seed] [-o per sensor csv]
+*/
+#include "fleet_sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+static uint32_t milliseconds(const char *value) {
+    return (uint32_t)lround(atof(value) * 1000);
+}
+
+static double percentile(const std::vector<double> &sorted, double fraction) {
+    return sorted[(size_t)(fraction * (sorted.size() - 1))];
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "usage: %s [-n sensors] [-h hours] [-p period] [-w window] [-s startup] [-j wake jitter]\n"
+                    "  [-d drift ppm] [-P sync|random|slots] [-S slots] [-i adv interval] [-J adv interval jitter]\n"
+                    "  [-l adv data length] [-I scan interval] [-W scan window] [-L loss] [-r seed] [-o csv]\n"
+                    "  times in ms\n", program);
+}
+
+int main(int argc, char **argv) {
+    FleetSim::Config config;
+    const char *csv = NULL;
+    int option;
+
+    while ((option = getopt(argc, argv, "n:h:p:w:s:j:d:P:S:i:J:l:I:W:L:r:o:")) != -1) {
+        switch (option) {
+        case 'n': config.sensors = atoi(optarg); break;
+        case 'h': config.hours = atof(optarg); break;
+        case 'p': config.period_us = milliseconds(optarg); break;
+        case 'w': config.window_us = milliseconds(optarg); break;
+        case 's': config.startup_us = milliseconds(optarg); break;
+        case 'j': config.wake_jitter_us = milliseconds(optarg); break;
+        case 'd': config.drift_ppm = atof(optarg); break;
+        case 'P':
+            if (!strcmp(optarg, "sync")) config.phasing = FleetSim::SYNCHRONIZED;
+            else if (!strcmp(optarg, "random")) config.phasing = FleetSim::RANDOM;
+            else if (!strcmp(optarg, "slots")) config.phasing = FleetSim::SLOTTED;
+            else { usage(argv[0]); return 2; }
+            break;
+        case 'S': config.slots = atoi(optarg); break;
+        case 'i': config.adv_interval_us = milliseconds(optarg); break;
+        case 'J': config.adv_interval_jitter_us = milliseconds(optarg); break;
+        case 'l': config.adv_data_len = atoi(optarg); break;
+        case 'I': config.scan_interval_us = milliseconds(optarg); break;
+        case 'W': config.scan_window_us = milliseconds(optarg); break;
+        case 'L': config.loss = atof(optarg); break;
+        case 'r': config.seed = strtoull(optarg, NULL, 0); break;
+        case 'o': csv = optarg; break;
+        default: usage(argv[0]); return 2;
+        }
+    }
+
+    if (!config.sensors || config.hours <= 0 || !config.period_us || config.window_us >= config.period_us ||
+        config.adv_interval_jitter_us >= config.adv_interval_us || !config.scan_interval_us ||
+        config.scan_window_us > config.scan_interval_us || config.adv_data_len > 31 ||
+        (config.phasing == FleetSim::SLOTTED && !config.slots)) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    clock_t started = clock();
+    FleetSim::Result result = FleetSim::run(config);
+    double elapsed = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+    std::vector<double> delivery;
+    uint64_t readings = 0, delivered = 0;
+    for (const FleetSim::SensorResult &sensor : result.sensors) {
+        readings += sensor.readings;
+        delivered += sensor.delivered;
+        if (sensor.readings) delivery.push_back((double)sensor.delivered / sensor.readings);
+    }
+    std::sort(delivery.begin(), delivery.end());
+
+    printf("%u sensors, %.1f h, period %.1f s, window %.1f s, adv interval %.1f ± %.1f ms, scan %.1f/%.1f ms\n",
+           config.sensors, config.hours, config.period_us / 1e6, config.window_us / 1e6,
+           config.adv_interval_us / 1e3, config.adv_interval_jitter_us / 1e3,
+           config.scan_window_us / 1e3, config.scan_interval_us / 1e3);
+    printf("simulated %llu advertising events, %llu PDUs in %.2f s\n\n",
+           (unsigned long long)result.events, (unsigned long long)result.pdus, elapsed);
+
+    printf("readings delivered:   %llu of %llu (%.3f %%)\n", (unsigned long long)delivered,
+           (unsigned long long)readings, readings ? 100.0 * delivered / readings : 0);
+    if (!delivery.empty()) {
+        printf("per sensor delivery:  min %.3f %%, 1st percentile %.3f %%, median %.3f %%, max %.3f %%\n",
+               100 * delivery.front(), 100 * percentile(delivery, 0.01), 100 * percentile(delivery, 0.5),
+               100 * delivery.back());
+    }
+    printf("duplicates:           %.2f per delivered reading\n", delivered ? (double)result.duplicates / delivered : 0);
+    printf("gateway packet rate:  %.1f/s mean, %u/s peak\n", result.mean_rate, result.peak_rate);
+    printf("PDUs:                 %.2f %% received, %.2f %% not scanned, %.2f %% collided, %.2f %% lost\n",
+           100.0 * result.received / result.pdus, 100.0 * result.not_scanned / result.pdus,
+           100.0 * result.collided / result.pdus, 100.0 * result.lost / result.pdus);
+
+    if (csv) {
+        FILE *file = fopen(csv, "w");
+        if (!file) {
+            fprintf(stderr, "could not write %s\n", csv);
+            return 1;
+        }
+
+        fprintf(file, "sensor,readings,delivered,received\n");
+        for (size_t i = 0; i < result.sensors.size(); i++) {
+            const FleetSim::SensorResult &sensor = result.sensors[i];
+            fprintf(file, "%zu,%u,%u,%u\n", i, sensor.readings, sensor.delivered, sensor.received);
+        }
+        fclose(file);
+    }
+
+    return 0;
+}
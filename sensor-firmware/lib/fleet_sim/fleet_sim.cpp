@@ -0,0 +1,288 @@
+#include "fleet_sim.h"
+
+#include <algorithm>
+#include <queue>
+
+#define CHANNELS 3
+#define ADV_DELAY_MAX_US 10000
+
+// Advertising events are kept in a timing wheel of 1.024 ms buckets, which
+// only needs to reach one advertising interval ahead. Wakes are a period
+// apart and go through a heap instead, one entry per sensor.
+#define BUCKET_SHIFT 10
+
+namespace {
+    // xoshiro256**, small state and a few cycles per number
+    class Random {
+    public:
+        explicit Random(uint64_t seed) {
+            for (int i = 0; i < 4; i++) {
+                // splitmix64 to spread the seed
+                seed += 0x9E3779B97F4A7C15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                state[i] = z ^ (z >> 31);
+            }
+        }
+
+        uint64_t next() {
+            uint64_t result = rotate(state[1] * 5, 7) * 9;
+            uint64_t t = state[1] << 17;
+            state[2] ^= state[0];
+            state[3] ^= state[1];
+            state[1] ^= state[2];
+            state[0] ^= state[3];
+            state[2] ^= t;
+            state[3] = rotate(state[3], 45);
+            return result;
+        }
+
+        // 0 ..< range, by multiplication instead of modulo
+        uint32_t below(uint32_t range) {
+            return (uint32_t)(((next() >> 32) * range) >> 32);
+        }
+
+        double uniform() {
+            return (next() >> 11) * (1.0 / 9007199254740992.0);
+        }
+
+    private:
+        static uint64_t rotate(uint64_t x, int k) {
+            return (x << k) | (x >> (64 - k));
+        }
+
+        uint64_t state[4];
+    };
+
+    struct Sensor {
+        uint64_t next_wake;
+        uint64_t window_end;
+        uint32_t period;   // with the sensor's clock error
+        uint32_t interval; // of the current window
+        uint32_t window_received;
+        bool in_window;
+    };
+
+    struct Event {
+        uint64_t time;
+        uint32_t sensor;
+
+        bool operator<(const Event &other) const {
+            return time < other.time;
+        }
+
+        // std::priority_queue puts the largest first
+        bool operator>(const Event &other) const {
+            return time > other.time;
+        }
+    };
+
+    struct Channel {
+        uint64_t busy_until; // end of the latest PDU
+        uint64_t pending_end;
+        uint32_t pending_sensor;
+        bool pending;        // a receivable PDU that may still be hit by a later one
+    };
+
+    class Simulation {
+    public:
+        Simulation(const FleetSim::Config &config) : config(config), random(config.seed) {
+            airtime = FleetSim::airtimeMicroseconds(config.adv_data_len);
+            end = (uint64_t)(config.hours * 3600e6);
+
+            uint64_t horizon = config.adv_interval_us + config.adv_interval_jitter_us + ADV_DELAY_MAX_US;
+            uint32_t buckets = 2;
+            while (((uint64_t)buckets << BUCKET_SHIFT) <= horizon + (2ULL << BUCKET_SHIFT)) buckets *= 2;
+            wheel.resize(buckets);
+            // the first event of a window still gets its advDelay added
+            lookahead = ((uint64_t)buckets << BUCKET_SHIFT) - ADV_DELAY_MAX_US - (2 << BUCKET_SHIFT);
+
+            result = FleetSim::Result();
+            result.sensors.resize(config.sensors);
+            rates.assign(end / 1000000 + 2, 0);
+            sensors.resize(config.sensors);
+
+            for (uint32_t i = 0; i < config.sensors; i++) {
+                Sensor &sensor = sensors[i];
+                double drift = config.drift_ppm * (2 * random.uniform() - 1) * 1e-6;
+                sensor.period = (uint32_t)(config.period_us * (1 + drift));
+
+                uint64_t phase = 0;
+                if (config.phasing == FleetSim::RANDOM) {
+                    phase = random.below(config.period_us);
+                } else if (config.phasing == FleetSim::SLOTTED && config.slots) {
+                    phase = (uint64_t)config.period_us * random.below(config.slots) / config.slots;
+                }
+
+                // the jitter must not move the first wake before the start
+                sensor.next_wake = phase + config.wake_jitter_us;
+                wakes.push({ jittered(sensor.next_wake) + config.startup_us, i });
+            }
+        }
+
+        FleetSim::Result run() {
+            for (uint64_t bucket = 0;; bucket++) {
+                uint64_t start = bucket << BUCKET_SHIFT;
+                if (start > end && wakes.empty()) break;
+
+                // windows whose first event falls into the wheel's reach
+                while (!wakes.empty() && wakes.top().time < start + lookahead) {
+                    Event wake = wakes.top();
+                    wakes.pop();
+                    openWindow(wake.sensor, wake.time, start);
+                }
+
+                std::vector<Event> &events = wheel[bucket & (wheel.size() - 1)];
+                std::sort(events.begin(), events.end());
+                for (const Event &event : events) advertise(event);
+                events.clear();
+            }
+
+            // nothing is left that could still collide with a pending PDU
+            for (Channel &channel : channels) commit(channel);
+            for (uint32_t i = 0; i < config.sensors; i++) closeWindow(i);
+
+            uint64_t seconds = end / 1000000;
+            result.mean_rate = seconds ? (double)result.received / seconds : 0;
+            for (uint32_t rate : rates) result.peak_rate = std::max(result.peak_rate, rate);
+            return result;
+        }
+
+    private:
+        uint64_t jittered(uint64_t time) {
+            if (!config.wake_jitter_us) return time;
+            return time - config.wake_jitter_us + random.below(2 * config.wake_jitter_us + 1);
+        }
+
+        void schedule(uint64_t time, uint32_t sensor) {
+            wheel[(time >> BUCKET_SHIFT) & (wheel.size() - 1)].push_back({ time, sensor });
+        }
+
+        void openWindow(uint32_t index, uint64_t first_event, uint64_t now) {
+            Sensor &sensor = sensors[index];
+
+            // the previous window is long over, flush what may still be pending from it
+            for (Channel &channel : channels) {
+                if (channel.pending && channel.pending_end <= now) commit(channel);
+            }
+            closeWindow(index);
+
+            sensor.next_wake += sensor.period;
+            if (sensor.next_wake + config.startup_us <= end) {
+                wakes.push({ jittered(sensor.next_wake) + config.startup_us, index });
+            }
+
+            if (first_event > end) return;
+            sensor.in_window = true;
+            sensor.window_end = first_event + config.window_us;
+            sensor.interval = config.adv_interval_us;
+            if (config.adv_interval_jitter_us) {
+                sensor.interval += random.below(2 * config.adv_interval_jitter_us + 1);
+                sensor.interval -= config.adv_interval_jitter_us;
+            }
+            result.sensors[index].readings++;
+            schedule(first_event + random.below(ADV_DELAY_MAX_US + 1), index);
+        }
+
+        void closeWindow(uint32_t index) {
+            Sensor &sensor = sensors[index];
+            if (!sensor.in_window) return;
+
+            FleetSim::SensorResult &stats = result.sensors[index];
+            if (sensor.window_received) {
+                stats.delivered++;
+                result.duplicates += sensor.window_received - 1;
+            }
+            sensor.window_received = 0;
+            sensor.in_window = false;
+        }
+
+        void commit(Channel &channel) {
+            if (!channel.pending) return;
+
+            channel.pending = false;
+            sensors[channel.pending_sensor].window_received++;
+            result.sensors[channel.pending_sensor].received++;
+            result.received++;
+            rates[channel.pending_end / 1000000]++;
+        }
+
+        void transmit(uint8_t index, uint64_t start, bool receivable, uint32_t sensor) {
+            Channel &channel = channels[index];
+            uint64_t pdu_end = start + airtime;
+            result.pdus++;
+
+            if (channel.pending && channel.pending_end <= start) commit(channel);
+            if (!receivable) result.not_scanned++;
+
+            if (start < channel.busy_until) {
+                if (channel.pending) {
+                    channel.pending = false;
+                    result.collided++;
+                }
+                if (receivable) result.collided++;
+            } else if (receivable) {
+                if (config.loss > 0 && random.uniform() < config.loss) {
+                    result.lost++;
+                } else {
+                    channel.pending = true;
+                    channel.pending_end = pdu_end;
+                    channel.pending_sensor = sensor;
+                }
+            }
+
+            channel.busy_until = std::max(channel.busy_until, pdu_end);
+        }
+
+        // The gateway listens on channel scan % 3 from scan * scan_interval_us on,
+        // for scan_window_us. One division per event, the PDUs on the following
+        // channels only move the offset into the scan interval along.
+        void advertise(const Event &event) {
+            uint32_t step = airtime + config.channel_gap_us;
+            uint64_t scan = event.time / config.scan_interval_us;
+            uint32_t offset = event.time - scan * config.scan_interval_us;
+
+            result.events++;
+            for (uint8_t channel = 0; channel < CHANNELS; channel++) {
+                if (channel) {
+                    offset += step;
+                    while (offset >= config.scan_interval_us) {
+                        offset -= config.scan_interval_us;
+                        scan++;
+                    }
+                }
+
+                bool receivable = scan % CHANNELS == channel && offset + airtime <= config.scan_window_us;
+                transmit(channel, event.time + channel * step, receivable, event.sensor);
+            }
+
+            Sensor &sensor = sensors[event.sensor];
+            uint64_t next = event.time + sensor.interval + random.below(ADV_DELAY_MAX_US + 1);
+            if (next < sensor.window_end && next <= end) schedule(next, event.sensor);
+        }
+
+        const FleetSim::Config &config;
+        Random random;
+        uint32_t airtime;
+        uint64_t end;
+        uint64_t lookahead;
+
+        std::vector<Sensor> sensors;
+        std::vector<std::vector<Event>> wheel;
+        std::priority_queue<Event, std::vector<Event>, std::greater<Event>> wakes;
+        Channel channels[CHANNELS] = {};
+        std::vector<uint32_t> rates; // received PDUs per second
+        FleetSim::Result result;
+    };
+}
+
+// preamble, access address, header, advertiser address, data and CRC, see AdvFrame
+uint32_t FleetSim::airtimeMicroseconds(uint8_t adv_data_len) {
+    return (1 + 4 + 2 + 6 + adv_data_len + 3) * 8;
+}
+
+FleetSim::Result FleetSim::run(const Config &config) {
+    Simulation simulation(config);
+    return simulation.run();
+}
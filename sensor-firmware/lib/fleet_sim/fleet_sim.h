@@ -0,0 +1,74 @@
+#ifndef FLEET_SIM_H_
+#define FLEET_SIM_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+// Discrete event model of many sensors advertising to one gateway, to try
+// advertising parameters, windows and periods before they go into the
+// firmware.
+//
+// Every sensor wakes once per period (at its phase, with some jitter and
+// clock drift), needs startup_us until its first advertising event and then
+// sends one event per advertising interval (plus the 0..10 ms advDelay of the
+// spec) until the window ends. An event is one PDU on each of the channels
+// 37, 38 and 39, in that order. The gateway scans one channel per scan
+// interval, cycling through the three, for scan_window_us. It receives a PDU
+// that lies completely inside a scan window on its channel and does not
+// overlap any other PDU on that channel, there is no capture effect.
+namespace FleetSim {
+    enum Phasing {
+        SYNCHRONIZED, // all sensors powered on together and sleeping a fixed time
+        RANDOM,       // phase derived from the MAC address, see Fleet in the firmware
+        SLOTTED       // period split into slots, the MAC picks one
+    };
+
+    struct Config {
+        uint32_t sensors = 100;
+        double hours = 24;
+        uint64_t seed = 1;
+
+        uint32_t period_us = 60000000;
+        uint32_t window_us = 5000000;    // advertising window per wake
+        uint32_t startup_us = 600000;    // wake to first advertising event: boot, Bluetooth, measurement
+        uint32_t wake_jitter_us = 20000; // wakes are up to this much early or late
+        double drift_ppm = 0;            // clock error of each sensor, drawn from ± this
+        Phasing phasing = RANDOM;
+        uint16_t slots = 0;
+
+        uint32_t adv_interval_us = 500000;
+        uint32_t adv_interval_jitter_us = 50000; // each window draws its interval from ± this
+        uint8_t adv_data_len = 15;               // advertising data bytes, sets the airtime
+        uint32_t channel_gap_us = 150;           // between the PDUs of one event
+
+        uint32_t scan_interval_us = 10000;
+        uint32_t scan_window_us = 10000;
+        double loss = 0; // probability that the gateway misses a PDU regardless of collisions
+    };
+
+    struct SensorResult {
+        uint32_t readings;   // advertising windows
+        uint32_t delivered;  // windows with at least one PDU received
+        uint32_t received;   // PDUs received
+    };
+
+    struct Result {
+        uint64_t events;       // advertising events
+        uint64_t pdus;
+        uint64_t received;
+        uint64_t duplicates;   // received PDUs beyond the first of each window
+        uint64_t not_scanned;  // PDUs outside the scan window or on another channel
+        uint64_t collided;     // in a scan window, but overlapped by another PDU
+        uint64_t lost;         // in a scan window, but lost with probability loss
+        double mean_rate;      // received PDUs per second
+        uint32_t peak_rate;    // most PDUs received within one second
+        std::vector<SensorResult> sensors;
+    };
+
+    uint32_t airtimeMicroseconds(uint8_t adv_data_len);
+
+    Result run(const Config &config);
+}
+
+#endif
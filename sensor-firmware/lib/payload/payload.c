@@ -0,0 +1,220 @@
+#include "payload.h"
+#include "series.h"
+
+/* size and bit position of the flag of each field, in bit order */
+static const uint8_t field_sizes[PAYLOAD_FIELD_COUNT] = { 2, 2, 2, 2, 2, 1, 2 };
+static const uint8_t field_bits[PAYLOAD_FIELD_COUNT] = { 0, 1, 2, 3, 4, 5, 7 };
+
+#define FIELD_FLAGS ((uint8_t)~PAYLOAD_BATCH)
+/* the flags of the fields this version encodes, anything else in the flags byte is rejected */
+#define KNOWN_FIELDS (PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY | PAYLOAD_PRESSURE | PAYLOAD_SEQUENCE | \
+                      PAYLOAD_BATTERY | PAYLOAD_STATUS | PAYLOAD_PERIOD)
+#define LEGACY_FLAGS (PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY)
+/* every value takes at least one byte */
+#define MAX_BATCH_COUNT (PAYLOAD_MAX_FRAME_SIZE - 3)
+
+static uint8_t fields_size(uint8_t flags) {
+    uint8_t size = 0;
+    for (uint8_t i = 0; i < PAYLOAD_FIELD_COUNT; i++) {
+        size += field_sizes[i] & -((flags >> field_bits[i]) & 1);
+    }
+
+    return size;
+}
+
+static uint8_t encode_fields(const struct sensor_payload *payload, uint8_t flags, uint8_t *buffer) {
+    uint16_t values[PAYLOAD_FIELD_COUNT] = {
+        (uint16_t)payload->temperature, payload->humidity, payload->pressure,
+        payload->sequence, payload->battery, payload->status, payload->period
+    };
+
+    uint8_t len = 0;
+    for (uint8_t i = 0; i < PAYLOAD_FIELD_COUNT; i++) {
+        if (!(flags & (1 << field_bits[i]))) continue;
+
+        buffer[len++] = values[i] & 0xFF;
+        if (field_sizes[i] == 2) buffer[len++] = values[i] >> 8;
+    }
+
+    return len;
+}
+
+/*
+  Reads every field unconditionally, absent fields do not advance the offset
+  and are masked to zero. data must be readable one byte beyond the fields.
+*/
+static void decode_fields(const uint8_t *data, uint8_t version, uint8_t flags, struct sensor_payload *payload) {
+    uint16_t values[PAYLOAD_FIELD_COUNT];
+    uint8_t offset = 0;
+
+    for (uint8_t i = 0; i < PAYLOAD_FIELD_COUNT; i++) {
+        uint16_t present = -((flags >> field_bits[i]) & 1);
+        uint16_t wide = -(field_sizes[i] == 2);
+        values[i] = (data[offset] | ((data[offset + 1] << 8) & wide)) & present;
+        offset += field_sizes[i] & present;
+    }
+
+    payload->version = version;
+    payload->flags = flags;
+    payload->temperature = (int16_t)values[0];
+    payload->humidity = values[1];
+    payload->pressure = values[2];
+    payload->sequence = values[3];
+    payload->battery = values[4];
+    payload->status = values[5];
+    payload->period = values[6];
+}
+
+uint8_t payload_size(uint8_t flags) {
+    return 2 + fields_size(flags);
+}
+
+uint8_t payload_encode(const struct sensor_payload *payload, uint8_t *buffer) {
+    uint8_t flags = payload->flags & FIELD_FLAGS;
+    buffer[0] = PAYLOAD_VERSION_MARKER | PAYLOAD_VERSION;
+    buffer[1] = flags;
+    return 2 + encode_fields(payload, flags, buffer + 2);
+}
+
+static int32_t field_value(const struct sensor_payload *payload, uint8_t field) {
+    switch (field) {
+    case 0: return payload->temperature;
+    case 1: return payload->humidity;
+    case 2: return payload->pressure;
+    case 3: return payload->sequence;
+    case 4: return payload->battery;
+    case 5: return payload->status;
+    default: return payload->period;
+    }
+}
+
+/* returns 0 if the value is out of range for the field */
+static uint8_t set_field_value(struct sensor_payload *payload, uint8_t field, int32_t value) {
+    switch (field) {
+    case 0:
+        payload->temperature = value;
+        return value >= INT16_MIN && value <= INT16_MAX;
+    case 1: payload->humidity = value; break;
+    case 2: payload->pressure = value; break;
+    case 3: payload->sequence = value; break;
+    case 4: payload->battery = value; break;
+    case 5:
+        payload->status = value;
+        return value >= 0 && value <= UINT8_MAX;
+    default: payload->period = value; break;
+    }
+
+    return value >= 0 && value <= UINT16_MAX;
+}
+
+static void gather(const struct sensor_payload *records, uint8_t count, uint8_t field, int32_t *values) {
+    for (uint8_t i = 0; i < count; i++) values[i] = field_value(&records[i], field);
+}
+
+uint16_t payload_batch_size(const struct sensor_payload *records, uint8_t count, uint8_t flags) {
+    int32_t values[MAX_BATCH_COUNT];
+    uint16_t size = 3;
+    if (count > MAX_BATCH_COUNT) return UINT16_MAX;
+
+    for (uint8_t field = 0; field < PAYLOAD_FIELD_COUNT; field++) {
+        if (!(flags & (1 << field_bits[field]))) continue;
+
+        gather(records, count, field, values);
+        size += series_size(values, count);
+    }
+
+    return size;
+}
+
+uint8_t payload_encode_batch(const struct sensor_payload *records, uint8_t count, uint8_t flags, uint8_t *buffer) {
+    int32_t values[MAX_BATCH_COUNT];
+    if (count > MAX_BATCH_COUNT) return 0;
+
+    flags &= FIELD_FLAGS;
+    buffer[0] = PAYLOAD_VERSION_MARKER | PAYLOAD_VERSION;
+    buffer[1] = flags | PAYLOAD_BATCH;
+    buffer[2] = count;
+
+    uint8_t len = 3;
+    for (uint8_t field = 0; field < PAYLOAD_FIELD_COUNT; field++) {
+        if (!(flags & (1 << field_bits[field]))) continue;
+
+        gather(records, count, field, values);
+        uint16_t written = series_encode(values, count, buffer + len, PAYLOAD_MAX_FRAME_SIZE - len);
+        if (!written && count) return 0;
+        len += written;
+    }
+
+    return len;
+}
+
+static int8_t decode_series(const uint8_t *data, uint8_t len, uint8_t version, uint8_t flags,
+                            struct sensor_payload *records, uint8_t count) {
+    int32_t values[MAX_BATCH_COUNT];
+    uint8_t offset = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        struct sensor_payload *record = &records[i];
+        *record = (struct sensor_payload){ 0 };
+        record->version = version;
+        record->flags = flags;
+    }
+
+    for (uint8_t field = 0; field < PAYLOAD_FIELD_COUNT; field++) {
+        if (!(flags & (1 << field_bits[field]))) continue;
+
+        int16_t consumed = series_decode(data + offset, len - offset, values, count);
+        if (consumed < 0) return -1;
+        offset += consumed;
+
+        for (uint8_t i = 0; i < count; i++) {
+            if (!set_field_value(&records[i], field, values[i])) return -1;
+        }
+    }
+
+    return count;
+}
+
+/*
+  Single readings have their length validated once up front, the fields are
+  then decoded from a zero padded copy without further checks.
+*/
+int8_t payload_decode_batch(const uint8_t *data, uint8_t len, struct sensor_payload *records, uint8_t max_records) {
+    uint8_t padded[PAYLOAD_MAX_SIZE + 1] = { 0 };
+    uint8_t version, flags, offset, size;
+
+    if (len < 1 || len > PAYLOAD_MAX_FRAME_SIZE || max_records < 1) return -1;
+
+    if (data[0] & PAYLOAD_VERSION_MARKER) {
+        if (len < 2) return -1;
+        version = data[0] & ~PAYLOAD_VERSION_MARKER;
+        flags = data[1] & ~PAYLOAD_BATCH;
+        if (version != PAYLOAD_VERSION || (flags & ~KNOWN_FIELDS)) return -1;
+
+        if (data[1] & PAYLOAD_BATCH) {
+            if (len < 3 || data[2] > max_records || data[2] > MAX_BATCH_COUNT) return -1;
+            return decode_series(data + 3, len - 3, version, flags, records, data[2]);
+        }
+
+        offset = 2;
+    } else {
+        /* legacy firmware always sends both fields and knows no other flags */
+        if (data[0] & ~LEGACY_FLAGS) return -1;
+        version = 0;
+        flags = LEGACY_FLAGS;
+        offset = 1;
+    }
+
+    size = offset + fields_size(flags);
+    if (len < size) return -1;
+    for (uint8_t i = 0; i < size; i++) padded[i] = data[i];
+
+    decode_fields(padded + offset, version, flags, records);
+    return 1;
+}
+
+int8_t payload_decode(const uint8_t *data, uint8_t len, struct sensor_payload *payload) {
+    /* a batch of one decodes fine, but is not what the caller asked for */
+    if (len >= 2 && (data[0] & PAYLOAD_VERSION_MARKER) && (data[1] & PAYLOAD_BATCH)) return -1;
+    return payload_decode_batch(data, len, payload, 1) == 1 ? 0 : -1;
+}
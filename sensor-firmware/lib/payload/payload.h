@@ -0,0 +1,83 @@
+#ifndef PAYLOAD_H_
+#define PAYLOAD_H_
+
+#include <stdint.h>
+
+/*
+  Sensor readings as transmitted in the manufacturer specific data, after the
+  company ID. Little endian throughout.
+
+  version 1:  | 0x80 + version | flags | fields present in flags, in bit order |
+  batch:      | 0x80 + version | flags, with 0x40 | count | series of each field present in flags, in bit order |
+  legacy (0): | flags | temperature | humidity |
+
+  The header fields are one byte each, so a batch header is 3 bytes. The
+  first byte tells the formats apart: legacy firmware sends its flags there,
+  which never have bit 7 set. A batch stores each field as a series of count
+  delta encoded varints, see series.h.
+*/
+
+#define PAYLOAD_VERSION 1
+#define PAYLOAD_VERSION_MARKER 0x80
+
+#define PAYLOAD_TEMPERATURE 0x01 /* int16, 100 * °C */
+#define PAYLOAD_HUMIDITY    0x02 /* uint16, 100 * % relative humidity */
+#define PAYLOAD_PRESSURE    0x04 /* uint16, 10 * hPa */
+#define PAYLOAD_SEQUENCE    0x08 /* uint16, counter of reported readings, wraps around */
+#define PAYLOAD_BATTERY     0x10 /* uint16, mV */
+#define PAYLOAD_STATUS      0x20 /* uint8, PAYLOAD_STATUS_* bits */
+#define PAYLOAD_PERIOD      0x80 /* uint16, seconds until the next reading */
+#define PAYLOAD_FIELD_COUNT 7
+/* several readings, each with the fields selected by the other flags */
+#define PAYLOAD_BATCH       0x40
+
+/* the sequence counter started over, e.g. after a power cycle */
+#define PAYLOAD_STATUS_COLD_BOOT 0x01
+
+/* header and all fields */
+#define PAYLOAD_MAX_SIZE (2 + 6 * 2 + 1)
+/* what fits into the manufacturer specific data of a legacy advertisement, after the company ID */
+#define PAYLOAD_MAX_FRAME_SIZE (31 - 2 - 2)
+
+struct sensor_payload {
+    uint8_t version; /* 0 for legacy payloads */
+    uint8_t flags;
+    int16_t temperature;
+    uint16_t humidity;
+    uint16_t pressure;
+    uint16_t sequence;
+    uint16_t battery;
+    uint8_t status;
+    uint16_t period;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* number of bytes payload_encode writes for the given flags */
+uint8_t payload_size(uint8_t flags);
+
+/* writes the fields selected by payload->flags as the current version, returns the number of bytes written */
+uint8_t payload_encode(const struct sensor_payload *payload, uint8_t *buffer);
+
+/* number of bytes payload_encode_batch needs for the records, which may exceed PAYLOAD_MAX_FRAME_SIZE */
+uint16_t payload_batch_size(const struct sensor_payload *records, uint8_t count, uint8_t flags);
+
+/*
+  writes count records with the given fields as a batch to buffer (PAYLOAD_MAX_FRAME_SIZE bytes),
+  returns the number of bytes written or 0 if they do not fit
+*/
+uint8_t payload_encode_batch(const struct sensor_payload *records, uint8_t count, uint8_t flags, uint8_t *buffer);
+
+/* fields not present in the data are set to 0, returns 0 on success or -1 for malformed data and batches */
+int8_t payload_decode(const uint8_t *data, uint8_t len, struct sensor_payload *payload);
+
+/* decodes batches as well as single readings, returns the number of records or -1 for malformed data */
+int8_t payload_decode_batch(const uint8_t *data, uint8_t len, struct sensor_payload *records, uint8_t max_records);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
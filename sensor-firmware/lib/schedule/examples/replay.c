@@ -0,0 +1,189 @@
+/*
+  Replays a temperature trace against scheduling policies and reports, per
+  policy, the wakes and reports per day, the estimated energy and how late
+  changes reach the gateway.
+
+  A reading is reported when it left the deadband around the last reported
+  one, like the firmware does. A change counts as pending from the moment the
+  trace leaves the deadband around the last reported value until the next
+  reported reading, its latency is that time. Changes that return into the
+  deadband before any wake sees them are missed.
+
+  Energy is estimated from the wake cycle: a wake that only measures is
+  awake for WAKE_SECONDS, a report additionally keeps the radio on for the
+  advertising window. Currents are typical ESP32 figures, adjust them to the
+  board at hand.
+
+  Traces are text files with one "seconds temperature" pair (°C) per line,
+  e.g. exported readings of a fixed period sensor. Without a file, a
+  synthetic day in a heated office is replayed.
+
+  compile like this: gcc -O2 replay.c ../schedule.c -I .. -lm -o replay
+  usage: ./replay [trace file]
+*/
+#include "schedule.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define MAX_SAMPLES 200000
+#define DEADBAND 20 /* 0.2 °C, as in the firmware */
+
+#define WAKE_SECONDS 0.025
+#define WAKE_MILLIAMPS 40.0
+#define RADIO_SECONDS 5.0
+#define RADIO_MILLIAMPS 100.0
+#define SLEEP_MILLIAMPS 0.01
+
+struct sample {
+    double time;        /* seconds */
+    double temperature; /* °C */
+};
+
+static struct sample trace[MAX_SAMPLES];
+static int samples;
+
+/* heating from 6:00, sun in the afternoon, a window opened at 18:00, every 10 s */
+static void synthesize() {
+    for (samples = 0; samples < 24 * 360; samples++) {
+        double hour = samples / 360.0;
+        double temperature = 17.0;
+        if (hour >= 6) temperature += 4.0 * (1 - exp(-(hour - 6) * 2));
+        if (hour >= 12 && hour < 18) temperature += 1.5 * sin((hour - 12) / 6 * M_PI);
+        if (hour >= 18) temperature -= 3.0 * exp(-(hour - 18) * 6) * (1 - exp(-(hour - 18) * 30));
+        if (hour >= 22) temperature -= 4.0 * (1 - exp(-(hour - 22)));
+
+        trace[samples].time = samples * 10.0;
+        trace[samples].temperature = temperature + 0.02 * sin(samples * 0.7);
+    }
+}
+
+static int load(const char *path) {
+    FILE *file = fopen(path, "r");
+    if (!file) return 0;
+
+    samples = 0;
+    while (samples < MAX_SAMPLES &&
+           fscanf(file, "%lf %lf", &trace[samples].time, &trace[samples].temperature) == 2) {
+        if (samples && trace[samples].time <= trace[samples - 1].time) break;
+        samples++;
+    }
+
+    fclose(file);
+    return samples > 1;
+}
+
+/* in 100 * °C, linearly interpolated */
+static int32_t temperature_at(double time) {
+    static int index;
+    if (index && trace[index].time > time) index = 0;
+    while (index + 2 < samples && trace[index + 1].time <= time) index++;
+
+    const struct sample *a = &trace[index], *b = &trace[index + 1];
+    double t = (time - a->time) / (b->time - a->time);
+    if (t > 1) t = 1;
+    return (int32_t)lround(100 * (a->temperature + t * (b->temperature - a->temperature)));
+}
+
+struct result {
+    unsigned int wakes, reports;
+    double pending, max_latency; /* seconds */
+    unsigned int changes, missed;
+    int out_of_bounds;
+};
+
+/* wakes at the periods the policy picks, from the start to the end of the trace */
+static void replay(const struct schedule_config *config, struct result *result) {
+    struct schedule_state state = { { 0 }, 0, 0 };
+    double start = trace[0].time, end = trace[samples - 1].time;
+    double time = start, pending_since = -1;
+    int32_t reported = 0;
+    int first = 1, sample = 0;
+
+    *result = (struct result){ 0 };
+    while (time <= end) {
+        int32_t values[SCHEDULE_CHANNELS] = { temperature_at(time), 0, 0 };
+
+        /* changes that left the deadband since the last wake */
+        for (; sample < samples && trace[sample].time <= time; sample++) {
+            int32_t value = (int32_t)lround(100 * trace[sample].temperature);
+            if (first) continue;
+
+            if (pending_since < 0 && labs(value - reported) > DEADBAND) {
+                pending_since = trace[sample].time;
+                result->changes++;
+            } else if (pending_since >= 0 && labs(value - reported) <= DEADBAND) {
+                pending_since = -1;
+                result->missed++;
+            }
+        }
+
+        uint16_t period = schedule_update(config, &state, values);
+        if (period < config->min_period || period > config->max_period) result->out_of_bounds++;
+
+        result->wakes++;
+        if (first || labs(values[0] - reported) > DEADBAND) {
+            reported = values[0];
+            result->reports++;
+            if (pending_since >= 0) {
+                double latency = time - pending_since;
+                result->pending += latency;
+                if (latency > result->max_latency) result->max_latency = latency;
+                pending_since = -1;
+            }
+        }
+
+        first = 0;
+        time += period;
+    }
+}
+
+static void print(const char *name, const struct schedule_config *config, const struct result *result) {
+    double days = (trace[samples - 1].time - trace[0].time) / 86400;
+    double seconds = days * 86400;
+    double milliamp_seconds = result->wakes * WAKE_SECONDS * WAKE_MILLIAMPS +
+                              result->reports * RADIO_SECONDS * RADIO_MILLIAMPS + seconds * SLEEP_MILLIAMPS;
+
+    unsigned int reported = result->changes - result->missed;
+
+    printf("%-6s %5u..%-5u %8.0f %9.0f %9.2f %9.0f %9.0f %7u\n", name, config->min_period, config->max_period,
+           result->wakes / days, result->reports / days, milliamp_seconds / 3600 / days,
+           reported ? result->pending / reported : 0, result->max_latency, result->missed);
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1) {
+        if (!load(argv[1])) {
+            fprintf(stderr, "could not read a trace from %s\n", argv[1]);
+            return 2;
+        }
+    } else {
+        synthesize();
+    }
+
+    const struct { const char *name; struct schedule_config config; } policies[] = {
+        { "fixed", { SCHEDULE_STEP, 60, 60, { DEADBAND, 0, 0 } } },
+        { "fixed", { SCHEDULE_STEP, 300, 300, { DEADBAND, 0, 0 } } },
+        { "step", { SCHEDULE_STEP, 30, 900, { DEADBAND, 0, 0 } } },
+        { "step", { SCHEDULE_STEP, 60, 1800, { DEADBAND, 0, 0 } } },
+        { "rate", { SCHEDULE_RATE, 30, 900, { DEADBAND, 0, 0 } } },
+        { "rate", { SCHEDULE_RATE, 60, 1800, { DEADBAND, 0, 0 } } },
+    };
+
+    printf("%d samples over %.1f h, deadband %.1f °C\n\n", samples,
+           (trace[samples - 1].time - trace[0].time) / 3600, DEADBAND / 100.0);
+    printf("%-6s %11s %8s %9s %9s %9s %9s %7s\n", "policy", "period [s]", "wakes/d", "reports/d", "mAh/d",
+           "avg lat s", "max lat s", "missed");
+
+    int failures = 0;
+    for (unsigned int i = 0; i < sizeof(policies) / sizeof(policies[0]); i++) {
+        struct result result;
+        replay(&policies[i].config, &result);
+        print(policies[i].name, &policies[i].config, &result);
+        failures += result.out_of_bounds;
+    }
+
+    if (failures) printf("\n%d periods out of bounds\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,58 @@
+#include "schedule.h"
+
+static uint16_t clamp(const struct schedule_config *config, float period) {
+    if (period < config->min_period) return config->min_period;
+    if (period > config->max_period) return config->max_period;
+    return (uint16_t)period;
+}
+
+/* change since the last reading in steps, of the fastest changing channel */
+static float change(const struct schedule_config *config, const struct schedule_state *state, const int32_t *values) {
+    float steps = 0;
+    for (uint8_t i = 0; i < SCHEDULE_CHANNELS; i++) {
+        if (!config->resolution[i]) continue;
+
+        int32_t delta = values[i] - state->last[i];
+        float channel = (float)(delta < 0 ? -delta : delta) / config->resolution[i];
+        if (channel > steps) steps = channel;
+    }
+
+    return steps;
+}
+
+uint16_t schedule_period(const struct schedule_config *config, const struct schedule_state *state) {
+    return clamp(config, state->period ? state->period : config->min_period);
+}
+
+uint16_t schedule_update(const struct schedule_config *config, struct schedule_state *state,
+                         const int32_t *values) {
+    uint16_t period = schedule_period(config, state);
+    float steps = change(config, state, values);
+    float next;
+
+    for (uint8_t i = 0; i < SCHEDULE_CHANNELS; i++) state->last[i] = values[i];
+    /* the first reading has nothing to compare with */
+    if (!state->period) {
+        state->period = period;
+        return period;
+    }
+
+    switch (config->policy) {
+    case SCHEDULE_RATE:
+        state->rate = (state->rate + steps / period) / 2;
+        next = state->rate * 2 * period > 1 ? 1 / state->rate : 2.0f * period;
+        break;
+    default:
+        if (steps > 1) {
+            next = period / 2.0f;
+        } else if (steps < 0.5f) {
+            next = period * 2.0f;
+        } else {
+            next = period;
+        }
+        break;
+    }
+
+    state->period = clamp(config, next);
+    return state->period;
+}
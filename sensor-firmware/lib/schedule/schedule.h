@@ -0,0 +1,56 @@
+#ifndef SCHEDULE_H_
+#define SCHEDULE_H_
+
+#include <stdint.h>
+
+/*
+  Chooses the time until the next reading from how fast the readings change.
+  Changes are measured per channel in steps of its resolution (e.g. the
+  deadband of the channel), the fastest changing channel decides. The period
+  always stays within min_period and max_period, min_period == max_period
+  gives a fixed period.
+
+  SCHEDULE_STEP doubles the period while readings change by less than half a
+  step between readings and halves it when they change by more than one step.
+  SCHEDULE_RATE keeps an average of the rate of change and picks the period
+  in which it amounts to one step, growing by at most a factor of two per
+  reading.
+*/
+
+#define SCHEDULE_CHANNELS 3
+
+enum schedule_policy {
+    SCHEDULE_STEP,
+    SCHEDULE_RATE
+};
+
+struct schedule_config {
+    enum schedule_policy policy;
+    uint16_t min_period; /* seconds */
+    uint16_t max_period;
+    uint16_t resolution[SCHEDULE_CHANNELS]; /* in units of the values, 0 ignores the channel */
+};
+
+/* small enough for RTC memory, zero initialized it starts at min_period */
+struct schedule_state {
+    int32_t last[SCHEDULE_CHANNELS];
+    float rate; /* steps per second */
+    uint16_t period;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* period to use until the first reading */
+uint16_t schedule_period(const struct schedule_config *config, const struct schedule_state *state);
+
+/* takes the reading taken after the current period, returns the next period */
+uint16_t schedule_update(const struct schedule_config *config, struct schedule_state *state,
+                         const int32_t *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
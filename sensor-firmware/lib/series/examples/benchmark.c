@@ -0,0 +1,122 @@
+/*
+  Throughput of the series codec, and how many readings fit into one
+  advertising frame with it. The round trip checks are in test/test_series.
+  compile like this: gcc -O2 benchmark.c ../series.c ../../payload/payload.c -I .. -I ../../payload -I ../../../test -o benchmark
+*/
+#include "series.h"
+#include "payload.h"
+#include "xorshift.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_COUNT 255
+#define ROUNDS 20000
+
+static volatile int32_t sink; /* keeps the decoder from being optimized away */
+
+static int32_t step(int32_t max) {
+    return (int32_t)(next_random() % (2 * max + 1)) - max;
+}
+
+enum shape { CONSTANT, SMALL_STEPS, LARGE_STEPS, FULL_RANGE, EXTREMES, SHAPE_COUNT };
+static const char *shape_names[SHAPE_COUNT] = { "constant", "small steps", "large steps", "full range", "extremes" };
+
+static void generate(enum shape shape, int32_t *values, uint8_t count) {
+    int32_t value = (int32_t)next_random();
+    for (uint8_t i = 0; i < count; i++) {
+        switch (shape) {
+        case CONSTANT: break;
+        case SMALL_STEPS: value += step(3); break;
+        case LARGE_STEPS: value += step(100000); break;
+        case FULL_RANGE: value = (int32_t)next_random(); break;
+        case EXTREMES: value = next_random() & 1 ? INT32_MIN : INT32_MAX; break;
+        default: break;
+        }
+        values[i] = value;
+    }
+}
+
+/* readings of a sensor sampled every minute */
+static void walk(struct sensor_payload *records, uint8_t count, uint16_t sequence) {
+    int16_t temperature = 1800 + step(600);
+    uint16_t humidity = 4500 + step(2000);
+    uint16_t pressure = 10130 + step(200);
+
+    for (uint8_t i = 0; i < count; i++) {
+        struct sensor_payload *record = &records[i];
+        memset(record, 0, sizeof(*record));
+        record->flags = PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY | PAYLOAD_PRESSURE | PAYLOAD_SEQUENCE;
+        record->temperature = temperature += step(8);
+        record->humidity = humidity += step(30);
+        record->pressure = pressure += step(1);
+        record->sequence = sequence++;
+    }
+}
+
+static double seconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void throughput() {
+    int32_t values[MAX_COUNT], decoded[MAX_COUNT];
+    uint8_t buffer[MAX_COUNT * SERIES_MAX_VARINT_SIZE];
+    const int rounds = 200000;
+
+    printf("%-12s %8s %14s %14s\n", "series", "B/value", "encode [M/s]", "decode [M/s]");
+    for (int shape = 0; shape < SHAPE_COUNT; shape++) {
+        generate((enum shape)shape, values, MAX_COUNT);
+        uint16_t len = 0;
+
+        double start = seconds();
+        for (int i = 0; i < rounds; i++) {
+            values[i % MAX_COUNT] ^= i & 1;
+            len = series_encode(values, MAX_COUNT, buffer, sizeof(buffer));
+        }
+        double encoding = seconds() - start;
+
+        start = seconds();
+        for (int i = 0; i < rounds; i++) {
+            series_decode(buffer, len, decoded, MAX_COUNT);
+            sink = decoded[i % MAX_COUNT];
+        }
+        double decoding = seconds() - start;
+
+        double total = (double)rounds * MAX_COUNT / 1e6;
+        printf("%-12s %8.2f %14.1f %14.1f\n", shape_names[shape], (double)len / MAX_COUNT,
+               total / encoding, total / decoding);
+    }
+}
+
+static void readings_per_frame() {
+    struct sensor_payload records[32];
+    uint8_t flags = PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY | PAYLOAD_PRESSURE | PAYLOAD_SEQUENCE;
+    unsigned int frames = 0, readings = 0, smallest = 32;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        walk(records, 32, next_random());
+
+        uint8_t count = 0;
+        while (count < 32 && payload_batch_size(records, count + 1, flags) <= PAYLOAD_MAX_FRAME_SIZE) count++;
+
+        frames++;
+        readings += count;
+        if (count < smallest) smallest = count;
+    }
+
+    printf("\nreadings per %u B frame (temperature, humidity, pressure, sequence)\n", PAYLOAD_MAX_FRAME_SIZE);
+    printf("  single reading:   1\n");
+    printf("  fixed 16 bit:     %u\n", (PAYLOAD_MAX_FRAME_SIZE - 3) / (payload_size(flags) - 2));
+    printf("  delta varint:     %.2f on average, at least %u\n", (double)readings / frames, smallest);
+}
+
+int main() {
+    throughput();
+    readings_per_frame();
+
+    return 0;
+}
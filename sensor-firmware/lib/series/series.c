@@ -0,0 +1,63 @@
+#include "series.h"
+
+uint8_t series_varint_size(uint32_t value) {
+    uint8_t size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+
+    return size;
+}
+
+uint16_t series_size(const int32_t *values, uint8_t count) {
+    uint16_t size = 0;
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        size += series_varint_size(series_zigzag((int32_t)((uint32_t)values[i] - previous)));
+        previous = values[i];
+    }
+
+    return size;
+}
+
+uint16_t series_encode(const int32_t *values, uint8_t count, uint8_t *buffer, uint16_t max_len) {
+    uint16_t len = 0;
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t entry = series_zigzag((int32_t)((uint32_t)values[i] - previous));
+        previous = values[i];
+
+        if (len + series_varint_size(entry) > max_len) return 0;
+        while (entry >= 0x80) {
+            buffer[len++] = (entry & 0x7F) | 0x80;
+            entry >>= 7;
+        }
+        buffer[len++] = entry;
+    }
+
+    return len;
+}
+
+int16_t series_decode(const uint8_t *data, uint16_t len, int32_t *values, uint8_t count) {
+    uint16_t offset = 0;
+    uint32_t previous = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t entry = 0;
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            if (offset == len || shift == 7 * SERIES_MAX_VARINT_SIZE) return -1;
+            byte = data[offset++];
+            /* the last byte only has 4 bits left */
+            if (shift == 28 && (byte & 0x70)) return -1;
+            entry |= (uint32_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+
+        previous += (uint32_t)series_unzigzag(entry);
+        values[i] = (int32_t)previous;
+    }
+
+    return offset;
+}
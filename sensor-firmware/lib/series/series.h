@@ -0,0 +1,49 @@
+#ifndef SERIES_H_
+#define SERIES_H_
+
+#include <stdint.h>
+
+/*
+  Compact encoding of slowly changing integer series, such as consecutive
+  readings of one sensor channel.
+
+  | first value | delta to the previous value | ... |
+
+  Every entry is zigzag encoded, so that small negative numbers stay small,
+  and written as a varint: 7 bits per byte, least significant group first,
+  bit 7 set on all bytes but the last. Deltas wrap around at 32 bits, any
+  int32_t series round trips.
+*/
+
+/* a zigzag encoded 32 bit value needs at most 5 varint bytes */
+#define SERIES_MAX_VARINT_SIZE 5
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint32_t series_zigzag(int32_t value) {
+    return ((uint32_t)value << 1) ^ (uint32_t)-(int32_t)((uint32_t)value >> 31);
+}
+
+static inline int32_t series_unzigzag(uint32_t value) {
+    return (int32_t)((value >> 1) ^ -(value & 1));
+}
+
+/* number of bytes the varint of value takes */
+uint8_t series_varint_size(uint32_t value);
+
+/* number of bytes series_encode writes for the values */
+uint16_t series_size(const int32_t *values, uint8_t count);
+
+/* writes the values to buffer, returns the number of bytes written or 0 if they do not fit into max_len bytes */
+uint16_t series_encode(const int32_t *values, uint8_t count, uint8_t *buffer, uint16_t max_len);
+
+/* reads count values, returns the number of bytes consumed or -1 for truncated or malformed data */
+int16_t series_decode(const uint8_t *data, uint16_t len, int32_t *values, uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+#include "adv_frame.h"
+
+#include <string.h>
+
+#define DEVICE_NAME "NN Sensor"
+
+#define HEADER_SIZE 4
+
+static uint8_t frame[HEADER_SIZE + PAYLOAD_MAX_FRAME_SIZE] = {
+    3, 0xFF, // manufacturer specific data, length patched by update
+    AdvFrame::COMPANY_ID & 0xFF, AdvFrame::COMPANY_ID >> 8
+};
+static uint8_t frame_length = HEADER_SIZE;
+
+static uint8_t scan_response[2 + sizeof(DEVICE_NAME) - 1];
+
+void AdvFrame::update(const uint8_t *payload, uint8_t len) {
+    if (len > PAYLOAD_MAX_FRAME_SIZE) len = PAYLOAD_MAX_FRAME_SIZE;
+
+    memcpy(frame + HEADER_SIZE, payload, len);
+    frame_length = HEADER_SIZE + len;
+    frame[0] = frame_length - 1;
+}
+
+const uint8_t *AdvFrame::data() {
+    return frame;
+}
+
+uint8_t AdvFrame::length() {
+    return frame_length;
+}
+
+const uint8_t *AdvFrame::scanResponse() {
+    if (!scan_response[0]) {
+        scan_response[0] = sizeof(scan_response) - 1;
+        scan_response[1] = 0x09; // complete local name
+        memcpy(scan_response + 2, DEVICE_NAME, sizeof(DEVICE_NAME) - 1);
+    }
+
+    return scan_response;
+}
+
+uint8_t AdvFrame::scanResponseLength() {
+    return sizeof(scan_response);
+}
+
+uint32_t AdvFrame::airtimeMicroseconds(uint8_t adv_data_len) {
+    // preamble (1), access address (4), PDU header (2), AdvA (6), AdvData, CRC (3) at 1 µs per bit
+    return (1 + 4 + 2 + 6 + adv_data_len + 3) * 8;
+}
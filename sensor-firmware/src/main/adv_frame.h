@@ -0,0 +1,31 @@
+#ifndef ADV_FRAME_H
+#define ADV_FRAME_H
+
+#include <stdint.h>
+
+#include "payload.h"
+
+// The advertising data as it goes on air, shared by both BT backends. The
+// manufacturer specific data header is serialized at compile time, each
+// update only copies the encoded payload behind it and patches the length.
+//
+// | len | 0xFF | company ID (2) | payload, see payload.h |
+//
+// The device name is not advertised, it can be served as scan response
+// instead (BT_SCAN_RESPONSE_NAME).
+namespace AdvFrame {
+    const uint16_t COMPANY_ID = 0xFFFF;
+
+    // payload as written by payload_encode or payload_encode_batch, at most PAYLOAD_MAX_FRAME_SIZE bytes
+    void update(const uint8_t *payload, uint8_t len);
+    const uint8_t *data();
+    uint8_t length();
+
+    const uint8_t *scanResponse(); // complete local name
+    uint8_t scanResponseLength();
+
+    // time on air of one advertising PDU on the LE 1M PHY, which is sent once per channel
+    uint32_t airtimeMicroseconds(uint8_t adv_data_len);
+}
+
+#endif
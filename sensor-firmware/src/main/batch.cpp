@@ -0,0 +1,87 @@
+#include "batch.h"
+
+#include "esp_attr.h"
+
+#include "esp_log.h"
+static const char *tag = "Batch";
+
+RTC_DATA_ATTR static struct sensor_payload readings[Batch::CAPACITY];
+RTC_DATA_ATTR static uint8_t first;
+RTC_DATA_ATTR static uint8_t stored;
+
+static const struct sensor_payload &reading(uint8_t index) {
+    return readings[(first + index) % Batch::CAPACITY];
+}
+
+// Copies the readings from index on to records, in order.
+static uint8_t collect(uint8_t index, struct sensor_payload *records) {
+    for (uint8_t i = index; i < stored; i++) records[i - index] = reading(i);
+    return stored - index;
+}
+
+// Packs readings greedily starting at index, every frame carries the fields
+// of all of its readings. The delta encoding makes the size depend on the
+// values, so each additional reading is sized with its predecessors.
+// Returns the number of readings in the frame.
+static uint8_t pack(uint8_t index, uint8_t *flags) {
+    struct sensor_payload records[Batch::CAPACITY];
+    uint8_t available = collect(index, records);
+    uint8_t count = 0;
+    *flags = 0;
+
+    while (count < available) {
+        uint8_t combined = *flags | records[count].flags;
+        if (payload_batch_size(records, count + 1, combined) > PAYLOAD_MAX_FRAME_SIZE) break;
+
+        *flags = combined;
+        count++;
+    }
+
+    return count;
+}
+
+void Batch::append(const struct sensor_payload &payload) {
+    if (stored == CAPACITY) {
+        ESP_LOGW(tag, "Buffer full, dropping reading %u", reading(0).sequence);
+        first = (first + 1) % CAPACITY;
+        stored--;
+    }
+
+    readings[(first + stored) % CAPACITY] = payload;
+    stored++;
+}
+
+uint8_t Batch::count() {
+    return stored;
+}
+
+void Batch::clear() {
+    first = 0;
+    stored = 0;
+}
+
+uint8_t Batch::frameCount() {
+    uint8_t frames = 0;
+    uint8_t flags;
+    for (uint8_t index = 0; index < stored; index += pack(index, &flags)) frames++;
+    return frames;
+}
+
+uint8_t Batch::encodeFrame(uint8_t frame, uint8_t *buffer) {
+    uint8_t index = 0;
+    uint8_t flags;
+    uint8_t count = pack(index, &flags);
+    while (frame-- && count) {
+        index += count;
+        count = pack(index, &flags);
+    }
+
+    if (!count) return 0;
+
+    // a single reading keeps the plain format, which gateways without batch support understand
+    if (stored == 1) return payload_encode(&reading(0), buffer);
+
+    struct sensor_payload records[CAPACITY];
+    collect(index, records);
+    return payload_encode_batch(records, count, flags, buffer);
+}
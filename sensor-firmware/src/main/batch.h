@@ -0,0 +1,24 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdint.h>
+
+#include "payload.h"
+
+// Readings waiting for transmission, kept in RTC slow memory across deep
+// sleep. When the buffer is full, the oldest reading is dropped. A batch is
+// sent as a sequence of frames, each packing as many readings as fit into
+// one advertisement.
+namespace Batch {
+    const uint8_t CAPACITY = 32;
+
+    void append(const struct sensor_payload &reading);
+    uint8_t count();
+    void clear();
+
+    uint8_t frameCount();
+    // writes the payload of a frame to buffer (PAYLOAD_MAX_FRAME_SIZE bytes), returns its length
+    uint8_t encodeFrame(uint8_t frame, uint8_t *buffer);
+}
+
+#endif
@@ -1,18 +1,53 @@
+#ifndef BT_USE_RAW_HCI
 #include "bt.h"
+#include "adv_frame.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_gap_ble_api.h"
 
 #include "esp_log.h"
 static const char *tag = "BT";
 
-#define UINT8_TO_STREAM(p, u8)   {*(p)++ = (uint8_t)(u8);}
-#define UINT16_TO_STREAM(p, u16) {*(p)++ = (uint8_t)(u16); *(p)++ = (uint8_t)((u16) >> 8);}
-#define PAYLOAD_SIZE 7
+#define GAP_TIMEOUT_MILLISECONDS 1000
+
+#define ADV_DATA_SET_BIT (1 << 0) // also used for the scan response
+#define ADV_STARTED_BIT  (1 << 1)
+#define ADV_STOPPED_BIT  (1 << 2)
+#define GAP_FAILED_BIT   (1 << 3)
 
 static esp_ble_adv_params_t adv_params = {};
-static esp_ble_adv_data_t adv_data = {};
-static uint8_t payload[PAYLOAD_SIZE];
-static const char *device_name = "NN Sensor";
+static EventGroupHandle_t gap_events;
+
+// called from the Bluedroid task
+static void gap_event_handler(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t *param) {
+    switch(event) {
+    case ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT:
+        xEventGroupSetBits(gap_events, param->adv_data_raw_cmpl.status == ESP_BT_STATUS_SUCCESS ? ADV_DATA_SET_BIT : GAP_FAILED_BIT);
+        break;
+    case ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT:
+        xEventGroupSetBits(gap_events, param->scan_rsp_data_raw_cmpl.status == ESP_BT_STATUS_SUCCESS ? ADV_DATA_SET_BIT : GAP_FAILED_BIT);
+        break;
+    case ESP_GAP_BLE_ADV_START_COMPLETE_EVT:
+        xEventGroupSetBits(gap_events, param->adv_start_cmpl.status == ESP_BT_STATUS_SUCCESS ? ADV_STARTED_BIT : GAP_FAILED_BIT);
+        break;
+    case ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT:
+        xEventGroupSetBits(gap_events, param->adv_stop_cmpl.status == ESP_BT_STATUS_SUCCESS ? ADV_STOPPED_BIT : GAP_FAILED_BIT);
+        break;
+    default:
+        break;
+    }
+}
 
-bool BT::init() {
+static bool wait_for(EventBits_t bit) {
+    EventBits_t bits = xEventGroupWaitBits(gap_events, bit | GAP_FAILED_BIT, pdTRUE, pdFALSE,
+                                           pdMS_TO_TICKS(GAP_TIMEOUT_MILLISECONDS));
+    return (bits & bit) && !(bits & GAP_FAILED_BIT);
+}
+
+bool BT::init(uint16_t adv_interval) {
     esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
 
     esp_err_t ret;
@@ -41,21 +76,37 @@ bool BT::init() {
         return false;
     }
 
-    if((ret = esp_ble_gap_set_device_name(device_name))) {
-        ESP_LOGE(tag, "Failed to set device name: %s", esp_err_to_name(ret));
+    if(!gap_events && !(gap_events = xEventGroupCreate())) {
+        ESP_LOGE(tag, "Could not create GAP event group");
         return false;
     }
 
-    adv_params.adv_int_min       = 800; // 500ms equivalent
-    adv_params.adv_int_max       = 800; // (multiply by 0.625ms)
+    if((ret = esp_ble_gap_register_callback(gap_event_handler))) {
+        ESP_LOGE(tag, "Failed to register GAP callback: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    adv_params.adv_int_min       = adv_interval;
+    adv_params.adv_int_max       = adv_interval;
     adv_params.adv_type          = ADV_TYPE_NONCONN_IND;
     adv_params.own_addr_type     = BLE_ADDR_TYPE_PUBLIC;
     adv_params.channel_map       = ADV_CHNL_ALL;
     adv_params.adv_filter_policy = ADV_FILTER_ALLOW_SCAN_ANY_CON_WLST;
 
-    adv_data.include_name = true;
-    adv_data.manufacturer_len = PAYLOAD_SIZE;
-    adv_data.p_manufacturer_data = payload;
+#ifdef BT_SCAN_RESPONSE_NAME
+    adv_params.adv_type = ADV_TYPE_SCAN_IND;
+
+    xEventGroupClearBits(gap_events, ADV_DATA_SET_BIT | GAP_FAILED_BIT);
+    if((ret = esp_ble_gap_config_scan_rsp_data_raw((uint8_t *)AdvFrame::scanResponse(), AdvFrame::scanResponseLength()))) {
+        ESP_LOGE(tag, "Failed to set scan response: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if(!wait_for(ADV_DATA_SET_BIT)) {
+        ESP_LOGE(tag, "Scan response was not set");
+        return false;
+    }
+#endif
 
     return true;
 }
@@ -65,23 +116,60 @@ void BT::deinit() {
     esp_bt_controller_disable();
 }
 
-void BT::advertise(uint16_t temperature, uint16_t humidity) {
-    uint8_t* stream = payload;
-    UINT16_TO_STREAM(stream, 0xFFFF); // company ID
-    UINT8_TO_STREAM(stream, 3);       // flags of submitted data (0x1 temperature | 0x2 humidity)
-    UINT16_TO_STREAM(stream, temperature);
-    UINT16_TO_STREAM(stream, humidity);
+bool BT::advertise(const uint8_t *payload, uint8_t len) {
+    // advertising must not start with the data of the previous cycle
+    if(!updateAdvertising(payload, len)) return false;
 
-    esp_err_t ret;
-    if((ret = esp_ble_gap_config_adv_data(&adv_data))) {
-        ESP_LOGE(tag, "Failed to set advertising data: %s", esp_err_to_name(ret));
-        return;
-    }
+    xEventGroupClearBits(gap_events, ADV_STARTED_BIT | GAP_FAILED_BIT);
 
+    esp_err_t ret;
     if ((ret = esp_ble_gap_start_advertising(&adv_params))) {
         ESP_LOGE(tag, "Failed to start advertising: %s", esp_err_to_name(ret));
-        return;
+        return false;
+    }
+
+    if(!wait_for(ADV_STARTED_BIT)) {
+        ESP_LOGE(tag, "Advertising did not start");
+        return false;
     }
 
     ESP_LOGI(tag, "Started advertising...");
-}
\ No newline at end of file
+    return true;
+}
+
+bool BT::updateAdvertising(const uint8_t *payload, uint8_t len) {
+    AdvFrame::update(payload, len);
+
+    xEventGroupClearBits(gap_events, ADV_DATA_SET_BIT | GAP_FAILED_BIT);
+
+    esp_err_t ret;
+    if((ret = esp_ble_gap_config_adv_data_raw((uint8_t *)AdvFrame::data(), AdvFrame::length()))) {
+        ESP_LOGE(tag, "Failed to set advertising data: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if(!wait_for(ADV_DATA_SET_BIT)) {
+        ESP_LOGE(tag, "Advertising data was not set");
+        return false;
+    }
+
+    return true;
+}
+
+bool BT::stopAdvertising() {
+    xEventGroupClearBits(gap_events, ADV_STOPPED_BIT | GAP_FAILED_BIT);
+
+    esp_err_t ret;
+    if((ret = esp_ble_gap_stop_advertising())) {
+        ESP_LOGE(tag, "Failed to stop advertising: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if(!wait_for(ADV_STOPPED_BIT)) {
+        ESP_LOGE(tag, "Advertising did not stop");
+        return false;
+    }
+
+    return true;
+}
+#endif
@@ -1,10 +1,19 @@
-#include "freertos/FreeRTOS.h"
-#include "esp_bt.h"
-#include "esp_bt_main.h"
-#include "esp_gap_ble_api.h"
+#include <stdint.h>
+
+#include "payload.h"
+
+// Non-connectable advertising of sensor readings. bt.cpp implements it on top
+// of Bluedroid, bt_hci.cpp (built with BT_USE_RAW_HCI) talks HCI to the
+// controller directly.
 
 namespace BT {
-    bool init();
+    // interval between advertising events in 0.625 ms units
+    bool init(uint16_t adv_interval);
     void deinit();
-    void advertise(uint16_t temperature, uint16_t humidity);
+    // payload as written by payload_encode or payload_encode_batch,
+    // returns once the controller has started advertising
+    bool advertise(const uint8_t *payload, uint8_t len);
+    // replaces the payload while advertising, e.g. to cycle through the frames of a batch
+    bool updateAdvertising(const uint8_t *payload, uint8_t len);
+    bool stopAdvertising();
 };
\ No newline at end of file
@@ -0,0 +1,142 @@
+#ifdef BT_USE_RAW_HCI
+#include "bt.h"
+#include "adv_frame.h"
+#include "hci.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_bt.h"
+
+#include "esp_log.h"
+static const char *tag = "BT";
+
+#define HCI_TIMEOUT_MILLISECONDS 1000
+
+static HCI::AdvParams adv_params = {
+    0, 0, // set by init
+#ifdef BT_SCAN_RESPONSE_NAME
+    HCI::ADV_SCAN_IND,
+#else
+    HCI::ADV_NONCONN_IND,
+#endif
+    HCI::ADDR_PUBLIC,
+    HCI::CHANNEL_ALL,
+    HCI::FILTER_NONE
+};
+
+static uint8_t packet[HCI::MAX_COMMAND_LEN];
+static TaskHandle_t waiting_task;
+static volatile uint16_t completed_opcode;
+static volatile uint8_t completed_status;
+
+static void send_available() {
+}
+
+// called from the controller task
+static int receive(uint8_t *data, uint16_t len) {
+    uint16_t opcode;
+    uint8_t status;
+    if (HCI::parseCommandComplete(data, len, &opcode, &status)) {
+        completed_opcode = opcode;
+        completed_status = status;
+        xTaskNotifyGive(waiting_task);
+    }
+
+    return 0;
+}
+
+static esp_vhci_host_callback_t vhci_callback = { send_available, receive };
+
+// sends the command in packet and waits for its Command Complete event
+static bool send(uint16_t len) {
+    uint16_t opcode = packet[1] | (packet[2] << 8);
+    if (!esp_vhci_host_check_send_available()) {
+        ESP_LOGE(tag, "Controller cannot accept HCI command 0x%04x", opcode);
+        return false;
+    }
+
+    waiting_task = xTaskGetCurrentTaskHandle();
+    esp_vhci_host_send_packet(packet, len);
+
+    if (!ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(HCI_TIMEOUT_MILLISECONDS))) {
+        ESP_LOGE(tag, "No response to HCI command 0x%04x", opcode);
+        return false;
+    }
+
+    if (completed_opcode != opcode || completed_status) {
+        ESP_LOGE(tag, "HCI command 0x%04x failed: 0x%02x", opcode, completed_status);
+        return false;
+    }
+
+    return true;
+}
+
+bool BT::init(uint16_t adv_interval) {
+    esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+
+    esp_err_t ret;
+    if ((ret = esp_bt_controller_mem_release(ESP_BT_MODE_CLASSIC_BT))) {
+        ESP_LOGE(tag, "Bluetooth controller release classic bt memory failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if ((ret = esp_bt_controller_init(&bt_cfg)) != ESP_OK) {
+        ESP_LOGE(tag, "Bluetooth controller initialize failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    if ((ret = esp_bt_controller_enable(ESP_BT_MODE_BLE)) != ESP_OK) {
+        ESP_LOGE(tag, "Bluetooth controller enable failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    esp_vhci_host_register_callback(&vhci_callback);
+
+#ifdef BT_SCAN_RESPONSE_NAME
+    if (!send(HCI::leSetScanResponseData(packet, AdvFrame::scanResponse(), AdvFrame::scanResponseLength()))) {
+        return false;
+    }
+#endif
+
+    adv_params.interval_min = adv_interval;
+    adv_params.interval_max = adv_interval;
+    return send(HCI::leSetAdvParams(packet, adv_params));
+}
+
+void BT::deinit() {
+    esp_bt_controller_disable();
+}
+
+bool BT::advertise(const uint8_t *payload, uint8_t len) {
+    if (!updateAdvertising(payload, len)) return false;
+
+    if (!send(HCI::leSetAdvEnable(packet, true))) {
+        ESP_LOGE(tag, "Failed to start advertising");
+        return false;
+    }
+
+    ESP_LOGI(tag, "Started advertising...");
+    return true;
+}
+
+// the controller accepts new advertising data while advertising
+bool BT::updateAdvertising(const uint8_t *payload, uint8_t len) {
+    AdvFrame::update(payload, len);
+
+    if (!send(HCI::leSetAdvData(packet, AdvFrame::data(), AdvFrame::length()))) {
+        ESP_LOGE(tag, "Failed to set advertising data");
+        return false;
+    }
+
+    return true;
+}
+
+bool BT::stopAdvertising() {
+    if (!send(HCI::leSetAdvEnable(packet, false))) {
+        ESP_LOGE(tag, "Failed to stop advertising");
+        return false;
+    }
+
+    return true;
+}
+#endif
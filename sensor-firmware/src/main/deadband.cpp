@@ -0,0 +1,61 @@
+#include "deadband.h"
+
+#include <stdlib.h>
+
+#include "esp_attr.h"
+
+#include "esp_log.h"
+static const char *tag = "Deadband";
+
+static Deadband::Thresholds thresholds;
+static uint16_t heartbeat_cycles = 1;
+
+RTC_DATA_ATTR static struct sensor_payload last_reported;
+RTC_DATA_ATTR static uint16_t cycles_since_report;
+RTC_DATA_ATTR static Deadband::Stats stats;
+
+static bool outside(int32_t value, int32_t reference, uint16_t threshold) {
+    return abs(value - reference) > threshold;
+}
+
+void Deadband::configure(const Thresholds &configured, uint16_t cycles) {
+    thresholds = configured;
+    heartbeat_cycles = cycles;
+}
+
+bool Deadband::heartbeatDue() {
+    return cycles_since_report + 1 >= heartbeat_cycles;
+}
+
+// channels that were not part of the last report always count as changed
+bool Deadband::changed(const struct sensor_payload &reading) {
+    uint8_t channels = PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY | PAYLOAD_PRESSURE;
+    if ((reading.flags & channels) & ~last_reported.flags) return true;
+
+    return (reading.flags & PAYLOAD_TEMPERATURE &&
+            outside(reading.temperature, last_reported.temperature, thresholds.temperature)) ||
+           (reading.flags & PAYLOAD_HUMIDITY &&
+            outside(reading.humidity, last_reported.humidity, thresholds.humidity)) ||
+           (reading.flags & PAYLOAD_PRESSURE &&
+            outside(reading.pressure, last_reported.pressure, thresholds.pressure));
+}
+
+void Deadband::reported(const struct sensor_payload &reading) {
+    last_reported = reading;
+    cycles_since_report = 0;
+    stats.reported++;
+}
+
+void Deadband::skipped() {
+    if (cycles_since_report < UINT16_MAX) cycles_since_report++;
+    stats.skipped++;
+}
+
+Deadband::Stats Deadband::getStats() {
+    return stats;
+}
+
+void Deadband::logStats() {
+    ESP_LOGI(tag, "%u readings reported, %u skipped since cold boot, %u cycles since the last report",
+             stats.reported, stats.skipped, cycles_since_report);
+}
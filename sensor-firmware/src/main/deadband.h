@@ -0,0 +1,37 @@
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+#include <stdint.h>
+
+#include "payload.h"
+
+// Decides whether a reading is worth reporting. A reading is reported when any
+// channel moved further than its threshold from the last reported reading, or
+// when the heartbeat is due. The last reported values and the counters are
+// kept in RTC slow memory across deep sleep.
+namespace Deadband {
+    struct Thresholds {
+        uint16_t temperature; // 100 * °C
+        uint16_t humidity;    // 100 * % relative humidity
+        uint16_t pressure;    // 10 * hPa
+    };
+
+    struct Stats {
+        uint32_t reported;
+        uint32_t skipped;
+    };
+
+    void configure(const Thresholds &thresholds, uint16_t heartbeat_cycles);
+
+    // whether this wake's reading will be reported whatever its values
+    bool heartbeatDue();
+    bool changed(const struct sensor_payload &reading);
+
+    void reported(const struct sensor_payload &reading);
+    void skipped();
+
+    Stats getStats();
+    void logStats();
+}
+
+#endif
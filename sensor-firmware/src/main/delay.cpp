@@ -0,0 +1,99 @@
+#include "delay.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_timer.h"
+#include "rom/ets_sys.h"
+
+#include "esp_log.h"
+static const char *tag = "Delay";
+
+// below this, blocking costs more than it saves
+#define BUSY_WAIT_MAX_MICROSECONDS 200
+
+// bucket i counts waits that overshot by less than 2^i µs, the last one everything beyond
+#define HISTOGRAM_BUCKETS 16
+
+enum Mechanism {
+    BUSY_WAIT,
+    TIMER,
+    MECHANISM_COUNT
+};
+
+struct Histogram {
+    uint32_t count;
+    uint64_t requested_us;
+    uint64_t actual_us;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+};
+
+static const char *mechanism_names[MECHANISM_COUNT] = { "busy wait", "timer" };
+static Histogram histograms[MECHANISM_COUNT];
+
+static esp_timer_handle_t timer = NULL;
+static TaskHandle_t waiting_task = NULL;
+
+static void timer_expired(void *) {
+    xTaskNotifyGive(waiting_task);
+}
+
+static bool wait_for_timer(uint32_t microseconds) {
+    if (!timer) {
+        esp_timer_create_args_t args = {};
+        args.callback = timer_expired;
+        args.name = "delay";
+
+        esp_err_t result;
+        if ((result = esp_timer_create(&args, &timer))) {
+            ESP_LOGE(tag, "Creating timer failed: %s", esp_err_to_name(result));
+            return false;
+        }
+    }
+
+    waiting_task = xTaskGetCurrentTaskHandle();
+    if (esp_timer_start_once(timer, microseconds) != ESP_OK) return false;
+
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    return true;
+}
+
+static void record(Mechanism mechanism, uint32_t requested, int64_t actual) {
+    Histogram &histogram = histograms[mechanism];
+    histogram.count++;
+    histogram.requested_us += requested;
+    histogram.actual_us += actual;
+
+    int64_t overshoot = actual - requested;
+    int bucket = 0;
+    while (bucket < HISTOGRAM_BUCKETS - 1 && overshoot >= (1LL << bucket)) bucket++;
+    histogram.buckets[bucket]++;
+}
+
+void Delay::wait(uint32_t microseconds) {
+    int64_t start = esp_timer_get_time();
+
+    Mechanism mechanism = BUSY_WAIT;
+    if (microseconds > BUSY_WAIT_MAX_MICROSECONDS && wait_for_timer(microseconds)) mechanism = TIMER;
+
+    // also covers a timer that fired early
+    int64_t elapsed = esp_timer_get_time() - start;
+    if (elapsed < microseconds) ets_delay_us(microseconds - elapsed);
+
+    record(mechanism, microseconds, esp_timer_get_time() - start);
+}
+
+void Delay::logHistogram() {
+    for (int i = 0; i < MECHANISM_COUNT; i++) {
+        const Histogram &histogram = histograms[i];
+        if (!histogram.count) continue;
+
+        ESP_LOGI(tag, "%s: %u waits, %llu us requested, %llu us actual", mechanism_names[i], histogram.count,
+                 (unsigned long long)histogram.requested_us, (unsigned long long)histogram.actual_us);
+        for (int bucket = 0; bucket < HISTOGRAM_BUCKETS; bucket++) {
+            if (!histogram.buckets[bucket]) continue;
+            ESP_LOGI(tag, "  overshoot %s %6d us: %u", bucket < HISTOGRAM_BUCKETS - 1 ? "<" : ">=",
+                     1 << (bucket < HISTOGRAM_BUCKETS - 1 ? bucket : bucket - 1), histogram.buckets[bucket]);
+        }
+    }
+}
@@ -0,0 +1,11 @@
+#include <stdint.h>
+
+// Precise waits for the sensor driver, independent of the FreeRTOS tick.
+// Short waits busy-wait, longer ones block on an esp_timer one-shot. Light
+// sleep while both cores are idle is left to tickless idle, see power.h.
+namespace Delay {
+    void wait(uint32_t microseconds);
+
+    // logs requested vs. actual duration of all waits since boot
+    void logHistogram();
+}
@@ -0,0 +1,45 @@
+#include "fleet.h"
+
+#include "esp_system.h"
+
+#include "esp_log.h"
+static const char *tag = "Fleet";
+
+// the controller rejects intervals below 20 ms for non-connectable advertising
+#define MIN_ADV_INTERVAL 0x20
+
+static uint16_t slots;
+static int16_t slot;
+
+// FNV-1a, spreads the sequential MACs of one production batch over the whole range
+static uint32_t device_hash() {
+    uint8_t mac[6];
+    if (esp_efuse_mac_get_default(mac) != ESP_OK) {
+        ESP_LOGE(tag, "Could not read MAC address");
+        return 0;
+    }
+
+    uint32_t hash = 2166136261u;
+    for (uint8_t i = 0; i < sizeof(mac); i++) {
+        hash = (hash ^ mac[i]) * 16777619u;
+    }
+
+    return hash;
+}
+
+void Fleet::configure(uint16_t configured_slots, int16_t configured_slot) {
+    slots = configured_slots;
+    slot = configured_slot;
+}
+
+uint32_t Fleet::phaseMilliseconds(uint32_t period_milliseconds) {
+    if (!slots) return device_hash() % period_milliseconds;
+
+    uint16_t own = slot >= 0 ? slot % slots : device_hash() % slots;
+    return (uint64_t)period_milliseconds * own / slots;
+}
+
+uint16_t Fleet::advertisingInterval(uint16_t interval, uint16_t jitter) {
+    int32_t drawn = (int32_t)interval - jitter + esp_random() % (2 * jitter + 1);
+    return drawn < MIN_ADV_INTERVAL ? MIN_ADV_INTERVAL : drawn;
+}
@@ -0,0 +1,22 @@
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+
+// Keeps sensors that share a gateway apart in time. Every device derives a
+// wake phase from its MAC address, so that devices powered on together do not
+// wake and advertise together. With slots, the period is split into that many
+// equal slots and each device wakes at the start of its own. The advertising
+// interval is drawn anew every wake around the nominal one, so that two
+// devices whose advertising events collide do not keep colliding.
+namespace Fleet {
+    // slots 0 places the phase anywhere in the period, slot -1 derives the slot from the MAC
+    void configure(uint16_t slots, int16_t slot);
+
+    uint32_t phaseMilliseconds(uint32_t period_milliseconds);
+
+    // in 0.625 ms units, within interval ± jitter
+    uint16_t advertisingInterval(uint16_t interval, uint16_t jitter);
+}
+
+#endif
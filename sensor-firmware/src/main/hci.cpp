@@ -0,0 +1,62 @@
+#include "hci.h"
+
+#include <string.h>
+
+static uint8_t *command(uint8_t *buffer, uint16_t opcode, uint8_t parameter_len) {
+    buffer[0] = HCI::COMMAND_PACKET;
+    buffer[1] = opcode & 0xFF;
+    buffer[2] = opcode >> 8;
+    buffer[3] = parameter_len;
+    return buffer + 4;
+}
+
+// advertising and scan response data share their layout: length, then always 31 bytes
+static uint16_t dataCommand(uint8_t *buffer, uint16_t opcode, const uint8_t *data, uint8_t len) {
+    if (len > HCI::ADV_DATA_MAX_LEN) len = HCI::ADV_DATA_MAX_LEN;
+
+    uint8_t *parameters = command(buffer, opcode, 1 + HCI::ADV_DATA_MAX_LEN);
+    parameters[0] = len;
+    memcpy(parameters + 1, data, len);
+    memset(parameters + 1 + len, 0, HCI::ADV_DATA_MAX_LEN - len);
+    return 4 + 1 + HCI::ADV_DATA_MAX_LEN;
+}
+
+uint16_t HCI::leSetAdvParams(uint8_t *buffer, const AdvParams &params) {
+    uint8_t *p = command(buffer, LE_SET_ADV_PARAMS, 15);
+    *p++ = params.interval_min & 0xFF;
+    *p++ = params.interval_min >> 8;
+    *p++ = params.interval_max & 0xFF;
+    *p++ = params.interval_max >> 8;
+    *p++ = params.type;
+    *p++ = params.own_addr_type;
+    *p++ = ADDR_PUBLIC;     // peer address type and peer address,
+    memset(p, 0, 6);        // only used for directed advertising
+    p += 6;
+    *p++ = params.channel_map;
+    *p++ = params.filter_policy;
+    return p - buffer;
+}
+
+uint16_t HCI::leSetAdvData(uint8_t *buffer, const uint8_t *data, uint8_t len) {
+    return dataCommand(buffer, LE_SET_ADV_DATA, data, len);
+}
+
+uint16_t HCI::leSetScanResponseData(uint8_t *buffer, const uint8_t *data, uint8_t len) {
+    return dataCommand(buffer, LE_SET_SCAN_RESPONSE_DATA, data, len);
+}
+
+uint16_t HCI::leSetAdvEnable(uint8_t *buffer, bool enable) {
+    uint8_t *parameters = command(buffer, LE_SET_ADV_ENABLE, 1);
+    parameters[0] = enable ? 1 : 0;
+    return 5;
+}
+
+bool HCI::parseCommandComplete(const uint8_t *packet, uint16_t len, uint16_t *opcode, uint8_t *status) {
+    // H4 type, event code, parameter length, number of allowed commands, opcode, status
+    if (len < 7 || packet[0] != EVENT_PACKET || packet[1] != COMMAND_COMPLETE_EVENT) return false;
+    if (packet[2] < 4 || len < 3 + packet[2]) return false;
+
+    *opcode = packet[4] | (packet[5] << 8);
+    *status = packet[6];
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef HCI_H
+#define HCI_H
+
+#include <stdint.h>
+
+// Encoding of the few LE controller commands needed for advertising, as H4
+// packets for the VHCI interface (Bluetooth Core Spec Vol 4 Part A and
+// Vol 4 Part E, section 7.8). Independent of ESP-IDF, so it also builds on
+// the host.
+namespace HCI {
+    const uint8_t COMMAND_PACKET = 0x01;
+    const uint8_t EVENT_PACKET = 0x04;
+    const uint8_t COMMAND_COMPLETE_EVENT = 0x0E;
+
+    const uint16_t LE_SET_ADV_PARAMS = 0x2006;
+    const uint16_t LE_SET_ADV_DATA = 0x2008;
+    const uint16_t LE_SET_SCAN_RESPONSE_DATA = 0x2009;
+    const uint16_t LE_SET_ADV_ENABLE = 0x200A;
+
+    const uint8_t ADV_IND = 0x00;
+    const uint8_t ADV_SCAN_IND = 0x02;
+    const uint8_t ADV_NONCONN_IND = 0x03;
+
+    const uint8_t ADDR_PUBLIC = 0x00;
+    const uint8_t ADDR_RANDOM = 0x01;
+
+    const uint8_t CHANNEL_ALL = 0x07;
+    const uint8_t FILTER_NONE = 0x00;
+
+    const uint8_t ADV_DATA_MAX_LEN = 31;
+    // H4 type, opcode, parameter length and the longest parameters we send
+    const uint16_t MAX_COMMAND_LEN = 4 + 1 + ADV_DATA_MAX_LEN;
+
+    struct AdvParams {
+        uint16_t interval_min; // 0.625 ms units
+        uint16_t interval_max;
+        uint8_t type;
+        uint8_t own_addr_type;
+        uint8_t channel_map;
+        uint8_t filter_policy;
+    };
+
+    // each returns the length of the packet written to buffer (at least MAX_COMMAND_LEN bytes)
+    uint16_t leSetAdvParams(uint8_t *buffer, const AdvParams &params);
+    uint16_t leSetAdvData(uint8_t *buffer, const uint8_t *data, uint8_t len);
+    uint16_t leSetScanResponseData(uint8_t *buffer, const uint8_t *data, uint8_t len);
+    uint16_t leSetAdvEnable(uint8_t *buffer, bool enable);
+
+    // returns whether the packet is a Command Complete event, and if so its opcode and status
+    bool parseCommandComplete(const uint8_t *packet, uint16_t len, uint16_t *opcode, uint8_t *status);
+}
+
+#endif
@@ -0,0 +1,158 @@
+#include "i2c.h"
+
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+
+#include "esp_log.h"
+static const char *tag = "I2C";
+
+#define I2C_TIMEOUT_MILLISECONDS 1000
+
+#define I2C_ERROR_CHECK(call) if((result = call)) { \
+                                  ESP_LOGE(tag, "I2C error in call: %s", esp_err_to_name(result)); \
+                                  release_link(command); \
+                                  stats.errors++; \
+                                  return -1; \
+                              }
+
+static i2c_port_t i2c_port;
+static I2C::Stats stats;
+
+#ifdef I2C_LINK_RECOMMENDED_SIZE
+// a register read queues two transfers (register address, then data)
+static uint8_t link_buffer[I2C_LINK_RECOMMENDED_SIZE(2)];
+
+static i2c_cmd_handle_t create_link() {
+    return i2c_cmd_link_create_static(link_buffer, sizeof(link_buffer));
+}
+
+static void release_link(i2c_cmd_handle_t command) {
+    i2c_cmd_link_delete_static(command);
+}
+#else
+// ESP-IDF before 4.4 has no static command links
+static i2c_cmd_handle_t create_link() {
+    return i2c_cmd_link_create();
+}
+
+static void release_link(i2c_cmd_handle_t command) {
+    i2c_cmd_link_delete(command);
+}
+#endif
+
+static esp_err_t execute(i2c_cmd_handle_t command) {
+    int64_t start = esp_timer_get_time();
+    esp_err_t result = i2c_master_cmd_begin(i2c_port, command, I2C_TIMEOUT_MILLISECONDS / portTICK_RATE_MS);
+    uint32_t duration = esp_timer_get_time() - start;
+
+    stats.transactions++;
+    stats.bus_time_us += duration;
+    if(duration > stats.max_call_us) stats.max_call_us = duration;
+
+    return result;
+}
+
+bool I2C::init(i2c_port_t port, int sda_pin, int scl_pin, uint32_t clock_speed_hz) {
+    i2c_port = port;
+
+    i2c_config_t i2c_config = {};
+    i2c_config.mode = I2C_MODE_MASTER;
+    i2c_config.sda_io_num = sda_pin;
+    i2c_config.scl_io_num = scl_pin;
+    i2c_config.sda_pullup_en = GPIO_PULLUP_ENABLE;
+    i2c_config.scl_pullup_en = GPIO_PULLUP_ENABLE;
+    i2c_config.master.clk_speed = clock_speed_hz;
+
+    esp_err_t result;
+    if((result = i2c_param_config(port, &i2c_config))) {
+        // Note: apparently for some misconfiguration (bad pins? no slave connected?) we do not reach
+        // this code, but get a panic... not sure if we can detect this...
+        ESP_LOGE(tag, "Configuring I2C failed: %s", esp_err_to_name(result));
+        return false;
+    }
+
+    if((result = i2c_driver_install(port, i2c_config.mode, 0, 0, 0))) {
+        ESP_LOGE(tag, "Installing I2C driver failed: %s", esp_err_to_name(result));
+        return false;
+    }
+
+    return true;
+}
+
+int8_t I2C::read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
+    /*
+     * Data on the bus should be like
+     * |----------------+---------------------|
+     * | I2C action     | Data                |
+     * |----------------+---------------------|
+     * | Start          | -                   |
+     * | Write          | (dev_id, write)     |
+     * | Write          | (reg_addr)          |
+     * | Repeated start | -                   |
+     * | Write          | (dev_id, read)      |
+     * | Read           | (reg_data[0])       |
+     * | Read           | (....)              |
+     * | Read           | (reg_data[len - 1]) |
+     * | Stop           | -                   |
+     * |----------------+---------------------|
+     */
+
+    ESP_LOGV(tag, "Reading %d bytes from 0x%x at 0x%x...", len, reg_addr, dev_id);
+    stats.calls++;
+
+    esp_err_t result;
+    i2c_cmd_handle_t command = create_link();
+    I2C_ERROR_CHECK(i2c_master_start(command))
+    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_WRITE, true))
+    I2C_ERROR_CHECK(i2c_master_write_byte(command, reg_addr, true))
+    I2C_ERROR_CHECK(i2c_master_start(command))
+    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_READ, true))
+    I2C_ERROR_CHECK(i2c_master_read(command, reg_data, len, I2C_MASTER_LAST_NACK))
+    I2C_ERROR_CHECK(i2c_master_stop(command))
+    I2C_ERROR_CHECK(execute(command))
+    release_link(command);
+
+    return 0;
+}
+
+int8_t I2C::write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
+    /*
+     * Data on the bus should be like
+     * |------------+---------------------|
+     * | I2C action | Data                |
+     * |------------+---------------------|
+     * | Start      | -                   |
+     * | Write      | (dev_id, write)     |
+     * | Write      | (reg_addr)          |
+     * | Write      | (reg_data[0])       |
+     * | Write      | (....)              |
+     * | Write      | (reg_data[len - 1]) |
+     * | Stop       | -                   |
+     * |------------+---------------------|
+     */
+
+    ESP_LOGV(tag, "Writing %d bytes to 0x%x at 0x%x...", len, reg_addr, dev_id);
+    stats.calls++;
+
+    esp_err_t result;
+    i2c_cmd_handle_t command = create_link();
+    I2C_ERROR_CHECK(i2c_master_start(command))
+    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_WRITE, true))
+    I2C_ERROR_CHECK(i2c_master_write_byte(command, reg_addr, true))
+    I2C_ERROR_CHECK(i2c_master_write(command, reg_data, len, true))
+    I2C_ERROR_CHECK(i2c_master_stop(command))
+    I2C_ERROR_CHECK(execute(command))
+    release_link(command);
+
+    return 0;
+}
+
+I2C::Stats I2C::getStats() {
+    return stats;
+}
+
+void I2C::logStats() {
+    ESP_LOGI(tag, "%u calls, %u transactions, %u errors, %llu us on the bus (longest call %u us)",
+             stats.calls, stats.transactions, stats.errors, (unsigned long long)stats.bus_time_us,
+             stats.max_call_us);
+}
@@ -0,0 +1,30 @@
+#ifndef I2C_H
+#define I2C_H
+
+#include <stdint.h>
+
+#include "driver/i2c.h"
+
+// I2C master transport for the BME280 driver. Every register access is a
+// single i2c_master_cmd_begin on a command link kept in static memory, so
+// reads and writes do not touch the heap.
+namespace I2C {
+    struct Stats {
+        uint32_t calls;        // reads and writes issued by the driver
+        uint32_t transactions; // i2c_master_cmd_begin calls
+        uint32_t errors;
+        uint64_t bus_time_us;  // time spent in i2c_master_cmd_begin
+        uint32_t max_call_us;
+    };
+
+    bool init(i2c_port_t port, int sda_pin, int scl_pin, uint32_t clock_speed_hz);
+
+    // signatures match the read and write callbacks of struct bme280_dev
+    int8_t read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
+    int8_t write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
+
+    Stats getStats();
+    void logStats();
+}
+
+#endif
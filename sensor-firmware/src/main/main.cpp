@@ -1,55 +1,307 @@
+#include "batch.h"
 #include "bt.h"
+#include "deadband.h"
+#include "delay.h"
+#include "fleet.h"
+#include "i2c.h"
+#include "phases.h"
+#include "power.h"
+#include "schedule.h"
 #include "sensor.h"
+#include "wake.h"
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
 #include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_sleep.h"
 #include "nvs_flash.h"
 
 #include "esp_log.h"
 static const char *tag = "MAIN";
 
 #define ADVERTISE_TIME_SECONDS 5
-#define SENSOR_READ_PERIOD_SECONDS 60
+
+// The time between readings widens while they are stable and tightens while
+// they change quickly, within these bounds, see schedule.h. A change of one
+// deadband counts as one step. Equal bounds keep a fixed period. Override with
+// e.g. -DPERIOD_MAX_SECONDS=900 -DSCHEDULE_POLICY=SCHEDULE_RATE.
+#ifndef PERIOD_MIN_SECONDS
+#define PERIOD_MIN_SECONDS 60
+#endif
+#ifndef PERIOD_MAX_SECONDS
+#define PERIOD_MAX_SECONDS 60
+#endif
+#ifndef SCHEDULE_POLICY
+#define SCHEDULE_POLICY SCHEDULE_STEP
+#endif
+static_assert(PERIOD_MIN_SECONDS > ADVERTISE_TIME_SECONDS && PERIOD_MIN_SECONDS <= PERIOD_MAX_SECONDS &&
+              PERIOD_MAX_SECONDS <= UINT16_MAX, "invalid period bounds");
+
+// Wakes land on multiples of the period on the RTC clock, shifted by a phase
+// derived from the MAC address, see fleet.h. After an adaptive period changes,
+// the next wake is the new period after the last one instead, so that the
+// period in the payload is the interval. With FLEET_SLOTS, the period is
+// split into that many slots, e.g. one advertising window each, and the
+// device wakes at the start of slot FLEET_SLOT, or of one picked by its MAC.
+#ifndef FLEET_SLOTS
+#define FLEET_SLOTS 0
+#endif
+#ifndef FLEET_SLOT
+#define FLEET_SLOT -1
+#endif
+
+// 500 ms (in 0.625 ms units), each wake draws an interval up to 10 % off it
+#define ADV_INTERVAL 800
+#define ADV_INTERVAL_JITTER 80
+
+// Readings are collected for this many wakes before the radio is brought up to
+// send them all at once, so the oldest one arrives up to
+// (BATCH_READINGS - 1) * PERIOD_MAX_SECONDS late. 1 sends every reading
+// right away. Override with e.g. -DBATCH_READINGS=5 in build_flags.
+#ifndef BATCH_READINGS
+#define BATCH_READINGS 1
+#endif
+static_assert(BATCH_READINGS >= 1 && BATCH_READINGS <= Batch::CAPACITY, "batch does not fit into RTC memory");
+
+// A reading is only reported when it left the deadband around the last
+// reported one, or at least every HEARTBEAT_CYCLES wakes, so that the gateway
+// knows the sensor is alive. Wakes without a report do not bring up the radio.
+// 1 reports every reading. Override with e.g. -DHEARTBEAT_CYCLES=15.
+#ifndef HEARTBEAT_CYCLES
+#define HEARTBEAT_CYCLES 1
+#endif
+static_assert(HEARTBEAT_CYCLES >= 1, "every reading needs to be reported eventually");
+#ifndef DEADBAND_TEMPERATURE
+#define DEADBAND_TEMPERATURE 20 // 0.2 °C
+#endif
+#ifndef DEADBAND_HUMIDITY
+#define DEADBAND_HUMIDITY 100   // 1 % relative humidity
+#endif
+#ifndef DEADBAND_PRESSURE
+#define DEADBAND_PRESSURE 5     // 0.5 hPa
+#endif
+
+// The CPU runs at the sdkconfig's default frequency while busy and drops to
+// CPU_MIN_MHZ whenever both cores are idle, most of all between the
+// advertising events of the window. With LIGHT_SLEEP it sleeps instead, as far
+// as the Bluetooth controller lets it: with the main crystal as its low power
+// clock (CONFIG_BTDM_LPCLK_SEL_MAIN_XTAL, boards without a 32 kHz crystal) the
+// controller keeps the chip out of light sleep while it is enabled.
+#ifndef CPU_MIN_MHZ
+#define CPU_MIN_MHZ CONFIG_ESP32_XTAL_FREQ
+#endif
+#ifndef LIGHT_SLEEP
+#define LIGHT_SLEEP 1
+#endif
+
+// Channels the sensor measures and reports besides temperature. Leaving out
+// pressure (-DSENSOR_CHANNELS=BME280_HUM) skips its conversion, shortens the
+// data read to 0xFA..0xFE and drops it from the payload.
+#ifndef SENSOR_CHANNELS
+#define SENSOR_CHANNELS BME280_ALL
+#endif
+
+// the frames of a batch take turns, each is on air for at least this long per window
+#define FRAME_ROTATION_MILLISECONDS 1000
+
+// The Bluetooth controller is pinned to core 0, the sensor is handled on core 1 meanwhile.
+#define SENSOR_TASK_CORE 1
+#define SENSOR_TASK_STACK_SIZE 4096
+#define SENSOR_TASK_PRIORITY 5
+#define SENSOR_TIMEOUT_MILLISECONDS 1000
+
+#define SENSOR_DONE_BIT   (1 << 0)
+#define SENSOR_FAILED_BIT (1 << 1)
+
+static EventGroupHandle_t sensor_events;
+
+// counts reported readings, so that the gateway can drop duplicates and detect lost ones
+RTC_DATA_ATTR static uint16_t sequence;
+RTC_DATA_ATTR static struct schedule_state schedule;
+static const struct schedule_config schedule_config = {
+    SCHEDULE_POLICY, PERIOD_MIN_SECONDS, PERIOD_MAX_SECONDS,
+    { DEADBAND_TEMPERATURE, DEADBAND_HUMIDITY, DEADBAND_PRESSURE }
+};
+static bool cold_boot;
+
+static bool bt_started;
 
 void deinit() {
-    BT::deinit();
+    if(bt_started) BT::deinit();
+    Phases::log();
+    Power::log();
+    Delay::logHistogram();
+    I2C::logStats();
+    Deadband::logStats();
+    Wake::logStats();
     ESP_LOGI(tag, "Going to sleep...");
-    esp_deep_sleep((SENSOR_READ_PERIOD_SECONDS - ADVERTISE_TIME_SECONDS) * 1000000);
+    uint32_t period = schedule_period(&schedule_config, &schedule) * 1000;
+    esp_deep_sleep(Wake::sleepDuration(period, Fleet::phaseMilliseconds(period)));
+}
+
+void measure(void *) {
+    EventBits_t result = SENSOR_FAILED_BIT;
+
+    Phases::begin(Phases::SENSOR_INIT);
+    if(!Sensor::init(SENSOR_CHANNELS)) {
+        ESP_LOGE(tag, "Sensor could not be initialized.");
+    } else {
+        Phases::end(Phases::SENSOR_INIT);
+
+        Phases::begin(Phases::MEASUREMENT);
+        if(!Sensor::startMeasurement() || !Sensor::readValues()) {
+            ESP_LOGE(tag, "Sensor could not perform measurement.");
+        } else {
+            Phases::end(Phases::MEASUREMENT);
+            result = SENSOR_DONE_BIT;
+        }
+    }
+
+    xEventGroupSetBits(sensor_events, result);
+    vTaskDelete(NULL);
+}
+
+// waits for the sensor task, so that we never go to sleep in the middle of a bus transaction
+bool wait_for_sensor() {
+    EventBits_t bits = xEventGroupWaitBits(sensor_events, SENSOR_DONE_BIT | SENSOR_FAILED_BIT, pdFALSE, pdFALSE,
+                                           pdMS_TO_TICKS(SENSOR_TIMEOUT_MILLISECONDS));
+    return bits & SENSOR_DONE_BIT;
+}
+
+struct sensor_payload build_payload() {
+    struct sensor_payload payload = {};
+    payload.flags = PAYLOAD_TEMPERATURE | PAYLOAD_SEQUENCE;
+    if(SENSOR_CHANNELS & BME280_HUM) payload.flags |= PAYLOAD_HUMIDITY;
+    if(SENSOR_CHANNELS & BME280_PRESS) payload.flags |= PAYLOAD_PRESSURE;
+    payload.temperature = Sensor::getTemperature();
+    payload.humidity = Sensor::getHumidity();
+    payload.pressure = Sensor::getPressure();
+
+    int32_t values[SCHEDULE_CHANNELS] = { payload.temperature, payload.humidity, payload.pressure };
+    payload.period = schedule_update(&schedule_config, &schedule, values);
+    // lets the gateway know when to expect the next reading, not needed for a fixed period
+    if(PERIOD_MIN_SECONDS != PERIOD_MAX_SECONDS) payload.flags |= PAYLOAD_PERIOD;
+
+    // the status is only worth its byte when something is to be reported
+    if(cold_boot) {
+        payload.flags |= PAYLOAD_STATUS;
+        payload.status |= PAYLOAD_STATUS_COLD_BOOT;
+    }
+
+    return payload;
+}
+
+// waits for this wake's reading and adds it to the batch, unless it is inside the deadband
+void record_reading(bool heartbeat) {
+    if(!wait_for_sensor()) {
+        ESP_LOGE(tag, "No sensor readings available.");
+        return;
+    }
+
+    struct sensor_payload reading = build_payload();
+    // a cold boot is always reported, the gateway learns about the restarted sequence from it
+    if(!heartbeat && !cold_boot && !Deadband::changed(reading)) {
+        Deadband::skipped();
+        return;
+    }
+
+    reading.sequence = ++sequence;
+    Deadband::reported(reading);
+    Batch::append(reading);
+}
+
+// sends the batch in its frames, round robin, for at least one advertising window
+bool advertise_batch() {
+    uint8_t frames = Batch::frameCount();
+    uint8_t payload[PAYLOAD_MAX_FRAME_SIZE];
+
+    ESP_LOGI(tag, "Advertising %u readings in %u frames...", Batch::count(), frames);
+    Phases::begin(Phases::ADV_START);
+    if(!BT::advertise(payload, Batch::encodeFrame(0, payload))) {
+        ESP_LOGE(tag, "Advertising could not be started.");
+        return false;
+    }
+    Phases::end(Phases::ADV_START);
+
+    uint32_t window = 1000 * ADVERTISE_TIME_SECONDS;
+    if(frames > 1 && window < frames * FRAME_ROTATION_MILLISECONDS) window = frames * FRAME_ROTATION_MILLISECONDS;
+    uint32_t rotation = frames > 1 ? FRAME_ROTATION_MILLISECONDS : window;
+
+    // the window counts from the moment the controller actually started advertising
+    Phases::begin(Phases::ADVERTISING);
+    for(uint32_t elapsed = 0, frame = 0; elapsed < window; elapsed += rotation) {
+        if(elapsed && frames > 1) {
+            frame = (frame + 1) % frames;
+            if(!BT::updateAdvertising(payload, Batch::encodeFrame(frame, payload))) break;
+        }
+
+        uint32_t remaining = window - elapsed;
+        vTaskDelay((remaining < rotation ? remaining : rotation) / portTICK_PERIOD_MS);
+    }
+    BT::stopAdvertising();
+    Phases::end(Phases::ADVERTISING);
+
+    return true;
 }
 
 extern "C" void app_main() {
+    Wake::begin();
     ESP_LOGI(tag, "Starting up...");
+    Power::configure({ CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, CPU_MIN_MHZ, LIGHT_SLEEP });
+    cold_boot = esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER;
+    bt_started = false;
+
+    Deadband::configure({ DEADBAND_TEMPERATURE, DEADBAND_HUMIDITY, DEADBAND_PRESSURE }, HEARTBEAT_CYCLES);
+    Fleet::configure(FLEET_SLOTS, FLEET_SLOT);
+    bool heartbeat = Deadband::heartbeatDue();
+    // Known before the measurement completes, so that Bluetooth comes up
+    // meanwhile. Otherwise the reading decides whether the radio is needed.
+    bool transmit = heartbeat && Batch::count() + 1 >= BATCH_READINGS;
+
+    sensor_events = xEventGroupCreate();
+    if(!sensor_events || xTaskCreatePinnedToCore(measure, "sensor", SENSOR_TASK_STACK_SIZE, NULL,
+                                                 SENSOR_TASK_PRIORITY, NULL, SENSOR_TASK_CORE) != pdPASS) {
+        ESP_LOGE(tag, "Sensor task could not be started.");
+        deinit();
+        return;
+    }
+
+    if(!transmit) {
+        record_reading(heartbeat);
+        if(Batch::count() < BATCH_READINGS) {
+            ESP_LOGI(tag, "Holding back %u readings.", Batch::count());
+            deinit();
+            return;
+        }
+    }
+
+    Phases::begin(Phases::NVS_INIT);
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
         ESP_ERROR_CHECK(nvs_flash_erase());
         ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK( ret );
+    Phases::end(Phases::NVS_INIT);
 
-    if(BT::init()) {
+    Phases::begin(Phases::BT_INIT);
+    bt_started = true;
+    if(BT::init(Fleet::advertisingInterval(ADV_INTERVAL, ADV_INTERVAL_JITTER))) {
         ESP_LOGI(tag, "Bluetooth initialized successfully.");
     } else {
         ESP_LOGE(tag, "Bluetooth could not be initialized.");
+        // the reading is kept for the next attempt
+        if(transmit) record_reading(heartbeat);
         deinit();
         return;
     }
+    Phases::end(Phases::BT_INIT);
 
-    if(!Sensor::init()) {
-        ESP_LOGE(tag, "Sensor could not be initialized.");
-        deinit();
-        return;
-    }
-
-    if(!Sensor::readValues()) {
-        ESP_LOGE(tag, "Sensor could not perform measurement.");
-        deinit();
-        return;
-    }
-
-    ESP_LOGI(tag, "Advertising readings...");
-    BT::advertise(Sensor::getTemperature(), Sensor::getHumidity());
+    if(transmit) record_reading(heartbeat);
 
-    vTaskDelay((1000 * ADVERTISE_TIME_SECONDS) / portTICK_PERIOD_MS);
+    // held back readings are still sent when this wake's measurement failed
+    if(Batch::count() && advertise_batch()) Batch::clear();
 
     deinit();
-}
\ No newline at end of file
+}
@@ -0,0 +1,84 @@
+#include "phases.h"
+#include "power.h"
+
+#include "freertos/FreeRTOS.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+
+#include "esp_log.h"
+static const char *tag = "Phases";
+
+static const char *names[Phases::PHASE_COUNT] = {
+    "NVS init",
+    "BT init",
+    "Sensor init",
+    "Measurement",
+    "Adv start",
+    "Advertising"
+};
+
+static int64_t start_times[Phases::PHASE_COUNT] = { -1, -1, -1, -1, -1, -1 };
+static int64_t end_times[Phases::PHASE_COUNT] = { -1, -1, -1, -1, -1, -1 };
+static int cores[Phases::PHASE_COUNT];
+static uint32_t idle_starts[Phases::PHASE_COUNT];
+static uint32_t idle_times[Phases::PHASE_COUNT];
+static uint32_t free_heap[Phases::PHASE_COUNT];
+
+void Phases::begin(Phase phase) {
+    start_times[phase] = esp_timer_get_time();
+    end_times[phase] = -1;
+    cores[phase] = xPortGetCoreID();
+    idle_starts[phase] = Power::idleMicroseconds(cores[phase]);
+}
+
+void Phases::end(Phase phase) {
+    end_times[phase] = esp_timer_get_time();
+    idle_times[phase] = Power::idleMicroseconds(cores[phase]) - idle_starts[phase];
+    free_heap[phase] = esp_get_free_heap_size();
+}
+
+Phases::Phase Phases::current() {
+    Phase phase = PHASE_COUNT;
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (start_times[i] >= 0 && end_times[i] < 0 &&
+            (phase == PHASE_COUNT || start_times[i] >= start_times[phase])) {
+            phase = (Phase)i;
+        }
+    }
+
+    return phase;
+}
+
+int64_t Phases::started(Phase phase) {
+    return start_times[phase];
+}
+
+int64_t Phases::duration(Phase phase) {
+    if (start_times[phase] < 0 || end_times[phase] < 0) return 0;
+    return end_times[phase] - start_times[phase];
+}
+
+int Phases::core(Phase phase) {
+    return cores[phase];
+}
+
+int64_t Phases::idle(Phase phase) {
+    if (start_times[phase] < 0 || end_times[phase] < 0) return 0;
+    return idle_times[phase];
+}
+
+uint32_t Phases::freeHeap(Phase phase) {
+    return free_heap[phase];
+}
+
+const char *Phases::name(Phase phase) {
+    return phase < PHASE_COUNT ? names[phase] : "(none)";
+}
+
+void Phases::log() {
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        if (start_times[i] < 0) continue;
+        ESP_LOGI(tag, "%-12s started at %8lld us on core %d, took %8lld us, %u B heap free after", names[i],
+                 (long long)start_times[i], cores[i], (long long)duration((Phase)i), free_heap[i]);
+    }
+}
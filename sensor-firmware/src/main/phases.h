@@ -0,0 +1,33 @@
+#ifndef PHASES_H
+#define PHASES_H
+
+#include <stdint.h>
+
+// Records when the steps of a wake cycle start and end, so that their
+// durations can be compared between builds.
+namespace Phases {
+    enum Phase {
+        NVS_INIT,
+        BT_INIT,
+        SENSOR_INIT,
+        MEASUREMENT,
+        ADV_START,   // from BT::advertise until the controller has started advertising
+        ADVERTISING, // the advertising window itself
+        PHASE_COUNT
+    };
+
+    void begin(Phase phase);
+    void end(Phase phase);
+
+    Phase current();              // most recently started phase that has not ended yet
+    int64_t started(Phase phase); // µs since boot, -1 if the phase did not run
+    int64_t duration(Phase phase);
+    int core(Phase phase);        // CPU core the phase was started on
+    int64_t idle(Phase phase);    // µs of the duration that core was idle, see Power
+    uint32_t freeHeap(Phase phase); // free heap in bytes when the phase ended
+    const char *name(Phase phase);
+
+    void log();
+}
+
+#endif
@@ -0,0 +1,65 @@
+#include "power.h"
+#include "phases.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_pm.h"
+
+#include "esp_log.h"
+static const char *tag = "Power";
+
+static Power::Config active = { CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ, false };
+
+bool Power::configure(const Config &config) {
+#if CONFIG_PM_ENABLE
+    esp_pm_config_esp32_t pm_config = {};
+    pm_config.max_freq_mhz = config.max_mhz;
+    pm_config.min_freq_mhz = config.min_mhz;
+    pm_config.light_sleep_enable = config.light_sleep;
+
+    // light sleep is rejected without CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    esp_err_t result;
+    if ((result = esp_pm_configure(&pm_config))) {
+        ESP_LOGE(tag, "Configuring power management failed: %s", esp_err_to_name(result));
+        return false;
+    }
+
+    active = config;
+    return true;
+#else
+    ESP_LOGW(tag, "Power management is disabled, CONFIG_PM_ENABLE is not set, see sdkconfig.defaults.");
+    return false;
+#endif
+}
+
+Power::Config Power::getConfig() {
+    return active;
+}
+
+uint32_t Power::idleMicroseconds(int core) {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    // in µs with CONFIG_FREERTOS_RUN_TIME_STATS_USING_ESP_TIMER, which is corrected after light sleep
+    TaskStatus_t status;
+    vTaskGetInfo(xTaskGetIdleTaskHandleForCPU(core), &status, pdFALSE, eRunning);
+    return status.ulRunTimeCounter;
+#else
+    return 0;
+#endif
+}
+
+void Power::log() {
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    for (int i = 0; i < Phases::PHASE_COUNT; i++) {
+        Phases::Phase phase = (Phases::Phase)i;
+        if (Phases::started(phase) < 0) continue;
+
+        int64_t idle = Phases::idle(phase);
+        ESP_LOGI(tag, "%-12s %8lld us at %u MHz, %8lld us idle at %u MHz%s", Phases::name(phase),
+                 (long long)(Phases::duration(phase) - idle), active.max_mhz, (long long)idle, active.min_mhz,
+                 active.light_sleep ? " or in light sleep" : "");
+    }
+#else
+    ESP_LOGI(tag, "CPU at %u..%u MHz, enable CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS for the time per phase",
+             active.min_mhz, active.max_mhz);
+#endif
+}
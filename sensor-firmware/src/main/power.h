@@ -0,0 +1,30 @@
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+// Dynamic frequency scaling and automatic light sleep. While a task runs, the
+// CPU is clocked at the maximum frequency. When both cores are idle, e.g. in
+// vTaskDelay during the advertising window, it drops to the minimum frequency
+// and, with tickless idle, into light sleep until the next task or interrupt
+// is due. The Bluetooth controller holds the clocks it needs around its
+// advertising events on its own.
+namespace Power {
+    struct Config {
+        uint16_t max_mhz;
+        uint16_t min_mhz;
+        bool light_sleep;
+    };
+
+    // false if power management is not enabled in the sdkconfig or was rejected
+    bool configure(const Config &config);
+    Config getConfig(); // the clock stays at max_mhz without a successful configure
+
+    // µs the idle task of the core ran, i.e. at min_mhz or asleep, wraps around after 71 minutes
+    uint32_t idleMicroseconds(int core);
+
+    // the CPU frequency each phase ran at, split into busy and idle time
+    void log();
+}
+
+#endif
@@ -1,71 +1,107 @@
 #include "sensor.h"
-
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
+#include "delay.h"
+#include "i2c.h"
+#include "selftest/bme280_selftest.h"
 
 #include "math.h"
 
-#include "driver/i2c.h"
+#include "esp_attr.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
 
 #include "esp_log.h"
 static const char *tag = "Sensor";
 
-static i2c_config_t i2c_config;
 #define SENSOR_SDA_PIN GPIO_NUM_22
 #define SENSOR_SCL_PIN GPIO_NUM_23
 #define I2C_PORT I2C_NUM_0
 #define I2C_CLOCK_FREQUENCY_HZ 100000
-#define I2C_TIMEOUT_MILLISECONDS 1000
-
-#define I2C_ERROR_CHECK(call) if((result = call)) { \
-                                  ESP_LOGE(tag, "I2C error in call: %s", esp_err_to_name(result)); \
-                                  return -1; \
-                              }
 
-// time was calculated according to BME280 data sheet for all measurements in 1x oversampling
-#define MEASURE_TIME_MILLISECONDS 10
 static struct bme280_dev device;
 static struct bme280_data sensor_data;
+static uint8_t channels = BME280_ALL;
+
+// Calibration and settings survive deep sleep in RTC memory, so that subsequent wakes
+// only need to confirm the sensor's calibration CRC instead of initializing it again.
+#define SENSOR_CACHE_MAGIC 0x42453238
+struct SensorCache {
+    uint32_t magic;
+    uint8_t calib_crc;
+    uint8_t channels;
+    struct bme280_calib_data calib_data;
+    struct bme280_settings settings;
+};
+RTC_DATA_ATTR static SensorCache cache;
 
 void user_delay_ms(uint32_t period);
-int8_t user_i2c_read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
-int8_t user_i2c_write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len);
-
-bool init_i2c() {
-    i2c_config.mode = I2C_MODE_MASTER;
-    i2c_config.sda_io_num = SENSOR_SDA_PIN;
-    i2c_config.scl_io_num = SENSOR_SCL_PIN;
-    i2c_config.sda_pullup_en = GPIO_PULLUP_ENABLE;
-    i2c_config.scl_pullup_en = GPIO_PULLUP_ENABLE;
-    i2c_config.master.clk_speed = I2C_CLOCK_FREQUENCY_HZ;
-
-    esp_err_t result;
-    if((result = i2c_param_config(I2C_PORT, &i2c_config))) {
-        // Note: apparently for some misconfiguration (bad pins? no slave connected?) we do not reach
-        // this code, but get a panic... not sure if we can detect this...
-        ESP_LOGE(tag, "Configuring I2C failed: %s", esp_err_to_name(result));
+uint32_t user_time_us();
+
+bool read_calib_crc(uint8_t *crc) {
+    int8_t result = bme280_get_regs(BME280_CRC_DATA_ADDR, crc, BME280_CRC_DATA_LEN, &device);
+    if(result != BME280_OK) {
+        ESP_LOGE(tag, "Reading calibration CRC failed: %d", result);
         return false;
     }
 
-    if((result = i2c_driver_install(I2C_PORT, i2c_config.mode, 0, 0, 0))) {
-        ESP_LOGE(tag, "Installing I2C driver failed: %s", esp_err_to_name(result));
+    return true;
+}
+
+bool restore_from_cache() {
+    if(cache.magic != SENSOR_CACHE_MAGIC || cache.channels != channels) return false;
+
+    uint8_t crc;
+    if(!read_calib_crc(&crc)) return false;
+
+    if(crc != cache.calib_crc) {
+        ESP_LOGW(tag, "Calibration CRC changed (0x%x -> 0x%x), sensor was replaced?", cache.calib_crc, crc);
         return false;
     }
 
+    device.chip_id = BME280_CHIP_ID;
+    device.calib_data = cache.calib_data;
+    device.settings = cache.settings;
+
     return true;
 }
 
-bool Sensor::init() {
+void store_in_cache() {
+    cache.magic = 0;
+
+    int8_t result = bme280_crc_selftest(&device);
+    if(result != BME280_OK) {
+        ESP_LOGW(tag, "Calibration self test failed: %d", result);
+        return;
+    }
+
+    if(!read_calib_crc(&cache.calib_crc)) return;
+
+    cache.channels = channels;
+    cache.calib_data = device.calib_data;
+    cache.settings = device.settings;
+    cache.magic = SENSOR_CACHE_MAGIC;
+}
+
+bool Sensor::init(uint8_t selected) {
+    channels = selected | BME280_TEMP;
+
     ESP_LOGI(tag, "Preparing I2C");
-    if(!init_i2c()) return false;
+    if(!I2C::init(I2C_PORT, SENSOR_SDA_PIN, SENSOR_SCL_PIN, I2C_CLOCK_FREQUENCY_HZ)) return false;
 
     ESP_LOGD(tag, "I2C has been prepared.");
 
     device.dev_id = BME280_I2C_ADDR_PRIM;
     device.intf = BME280_I2C_INTF;
-    device.read = user_i2c_read;
-    device.write = user_i2c_write;
+    device.read = I2C::read;
+    device.write = I2C::write;
     device.delay_ms = user_delay_ms;
+    // the driver's wait counts the conversion time from the trigger with these
+    device.delay_us = Delay::wait;
+    device.time_us = user_time_us;
+
+    if(esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && restore_from_cache()) {
+        ESP_LOGI(tag, "Restored BME280 calibration from RTC memory.");
+        return true;
+    }
 
     ESP_LOGI(tag, "Initializing BME280...");
     int8_t result = bme280_init(&device);
@@ -76,8 +112,9 @@ bool Sensor::init() {
 
     ESP_LOGD(tag, "BME280 has been initialized.");
 
-    device.settings.osr_h = BME280_OVERSAMPLING_1X;
-    device.settings.osr_p = BME280_OVERSAMPLING_1X;
+    // skipped channels shorten the conversion time
+    device.settings.osr_h = channels & BME280_HUM ? BME280_OVERSAMPLING_1X : BME280_NO_OVERSAMPLING;
+    device.settings.osr_p = channels & BME280_PRESS ? BME280_OVERSAMPLING_1X : BME280_NO_OVERSAMPLING;
     device.settings.osr_t = BME280_OVERSAMPLING_1X;
     device.settings.filter = BME280_FILTER_COEFF_OFF;
 
@@ -90,23 +127,38 @@ bool Sensor::init() {
 
     ESP_LOGD(tag, "BME280 has been configured.");
 
+    store_in_cache();
+
     return true;
 }
 
-bool Sensor::readValues() {
-    ESP_LOGI(tag, "Starting measurement and waiting...");
-    int8_t result = bme280_set_sensor_mode(BME280_FORCED_MODE, &device);
+bool Sensor::startMeasurement() {
+    ESP_LOGI(tag, "Starting measurement...");
+    int8_t result = bme280_trigger_measurement(&device);
     if(result != BME280_OK) {
         ESP_LOGE(tag, "Starting measurement failed: %d", result);
+        cache.magic = 0;
         return false;
     }
 
-    device.delay_ms(MEASURE_TIME_MILLISECONDS);
+    return true;
+}
+
+bool Sensor::readValues() {
+    ESP_LOGI(tag, "Waiting for measurement...");
+    int8_t result = bme280_wait_for_measurement(&device);
+    if(result != BME280_OK) {
+        ESP_LOGE(tag, "Waiting for measurement failed: %d", result);
+        cache.magic = 0;
+        return false;
+    }
 
     ESP_LOGI(tag, "Retrieving measurement data...");
-    result = bme280_get_sensor_data(BME280_ALL, &sensor_data, &device);
+    // reads only the data registers of the measured channels
+    result = bme280_fetch_measurement(channels, &sensor_data, &device);
     if(result != BME280_OK) {
         ESP_LOGE(tag, "Fetching sensor data failed: %d", result);
+        cache.magic = 0;
         return false;
     }
 
@@ -129,87 +181,9 @@ uint16_t Sensor::getPressure() {
 
 void user_delay_ms(uint32_t period) {
     ESP_LOGV(tag, "Waiting for %d ms", period);
-    vTaskDelay(period / portTICK_PERIOD_MS);
-}
-
-int8_t user_i2c_read(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
-    /*
-     * The parameter dev_id can be used as a variable to store the I2C address of the device
-     */
-
-    /*
-     * Data on the bus should be like
-     * |------------+---------------------|
-     * | I2C action | Data                |
-     * |------------+---------------------|
-     * | Start      | -                   |
-     * | Write      | (reg_addr)          |
-     * | Stop       | -                   |
-     * | Start      | -                   |
-     * | Read       | (reg_data[0])       |
-     * | Read       | (....)              |
-     * | Read       | (reg_data[len - 1]) |
-     * | Stop       | -                   |
-     * |------------+---------------------|
-     */
-
-    ESP_LOGV(tag, "Preparing cmd link to read data from 0x%x...", dev_id);
-    esp_err_t result;
-    i2c_cmd_handle_t command = i2c_cmd_link_create();
-    I2C_ERROR_CHECK(i2c_master_start(command))
-    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_WRITE, true))
-    I2C_ERROR_CHECK(i2c_master_write_byte(command, reg_addr, true))
-    I2C_ERROR_CHECK(i2c_master_stop(command)) // documented in the example above, but not in spec sheet
-    I2C_ERROR_CHECK(i2c_master_cmd_begin(I2C_PORT, command, I2C_TIMEOUT_MILLISECONDS / portTICK_RATE_MS))
-
-    ESP_LOGV(tag, "Asking to read...");
-    I2C_ERROR_CHECK(i2c_master_cmd_begin(I2C_PORT, command, I2C_TIMEOUT_MILLISECONDS / portTICK_RATE_MS))
-    ESP_LOGV(tag, "Finished asking to read.");
-
-    command = i2c_cmd_link_create();
-    I2C_ERROR_CHECK(i2c_master_start(command)) // documented in the example above, but not in spec sheet
-    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_READ, true))
-    I2C_ERROR_CHECK(i2c_master_read(command, reg_data, len, I2C_MASTER_LAST_NACK))
-    I2C_ERROR_CHECK(i2c_master_stop(command))
-
-    ESP_LOGV(tag, "Beginning to read...");
-    I2C_ERROR_CHECK(i2c_master_cmd_begin(I2C_PORT, command, I2C_TIMEOUT_MILLISECONDS / portTICK_RATE_MS))
-    ESP_LOGV(tag, "Finished reading.");
-
-    return 0;
+    Delay::wait(period * 1000);
 }
 
-int8_t user_i2c_write(uint8_t dev_id, uint8_t reg_addr, uint8_t *reg_data, uint16_t len) {
-    /*
-     * The parameter dev_id can be used as a variable to store the I2C address of the device
-     */
-
-    /*
-     * Data on the bus should be like
-     * |------------+---------------------|
-     * | I2C action | Data                |
-     * |------------+---------------------|
-     * | Start      | -                   |
-     * | Write      | (reg_addr)          |
-     * | Write      | (reg_data[0])       |
-     * | Write      | (....)              |
-     * | Write      | (reg_data[len - 1]) |
-     * | Stop       | -                   |
-     * |------------+---------------------|
-     */
-
-    ESP_LOGV(tag, "Preparing cmd link to write data to 0x%x...", dev_id);
-    esp_err_t result;
-    i2c_cmd_handle_t command = i2c_cmd_link_create();
-    I2C_ERROR_CHECK(i2c_master_start(command))
-    I2C_ERROR_CHECK(i2c_master_write_byte(command, (dev_id << 1) | I2C_MASTER_WRITE, true))
-    I2C_ERROR_CHECK(i2c_master_write_byte(command, reg_addr, true))
-    I2C_ERROR_CHECK(i2c_master_write(command, reg_data, len, true))
-    I2C_ERROR_CHECK(i2c_master_stop(command))
-
-    ESP_LOGV(tag, "Beginning to write...");
-    I2C_ERROR_CHECK(i2c_master_cmd_begin(I2C_PORT, command, I2C_TIMEOUT_MILLISECONDS / portTICK_RATE_MS))
-    ESP_LOGV(tag, "Finished writing.");
-
-    return 0;
+uint32_t user_time_us() {
+    return esp_timer_get_time();
 }
@@ -1,10 +1,15 @@
 #include "bme280.h"
 
 namespace Sensor {
-    bool init();
+    // channels is a mask of BME280_PRESS and BME280_HUM, temperature is always
+    // measured; the others are skipped in the conversion and not read
+    bool init(uint8_t channels);
+    // starts a conversion, readValues waits for and fetches its result
+    bool startMeasurement();
     bool readValues();
 
     int16_t getTemperature(); // temperature in 100 * °C
     uint16_t getHumidity();   // humidity in 100 * % relative humidity
     uint16_t getPressure();   // pressure in 10 * hPa (or Pascal / 10)
+    // channels that are not measured read as 0
 }
\ No newline at end of file
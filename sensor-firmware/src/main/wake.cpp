@@ -0,0 +1,93 @@
+#include "wake.h"
+
+#include <math.h>
+
+#include "esp_attr.h"
+#include "esp_sleep.h"
+
+// esp_clk_rtc_time moved between ESP-IDF releases
+#if __has_include("esp_private/esp_clk.h")
+#include "esp_private/esp_clk.h"
+#elif __has_include("esp32/clk.h")
+#include "esp32/clk.h"
+#else
+#include "esp_clk.h"
+#endif
+
+#include "esp_log.h"
+static const char *tag = "Wake";
+
+#define MIN_SLEEP_MICROSECONDS 1000000ULL
+
+static uint64_t woke_at;
+
+RTC_DATA_ATTR static uint64_t target; // RTC time app_main should start at, 0 if unknown
+RTC_DATA_ATTR static Wake::Stats stats;
+
+void Wake::begin() {
+    woke_at = esp_clk_rtc_time();
+    if (esp_sleep_get_wakeup_cause() != ESP_SLEEP_WAKEUP_TIMER || !target) {
+        // RTC memory survives resets, the next wake starts a new schedule
+        target = 0;
+        stats = {};
+        return;
+    }
+
+    int64_t error = (int64_t)(woke_at - target);
+    if (!stats.wakes || error < stats.min_error_us) stats.min_error_us = error;
+    if (!stats.wakes || error > stats.max_error_us) stats.max_error_us = error;
+    stats.wakes++;
+    stats.last_error_us = error;
+    stats.error_sum_us += error;
+    stats.error_square_sum += error * error;
+
+    // half of the error each wake, so that a single slow boot does not throw it off
+    stats.boot_estimate_us += error / 2;
+    if (stats.boot_estimate_us < 0) stats.boot_estimate_us = 0;
+}
+
+uint64_t Wake::sleepDuration(uint32_t period_milliseconds, uint32_t phase_milliseconds) {
+    uint64_t period = period_milliseconds * 1000ULL;
+    uint64_t phase = phase_milliseconds * 1000ULL % period;
+    uint64_t now = esp_clk_rtc_time();
+
+    uint64_t earliest = now + stats.boot_estimate_us + MIN_SLEEP_MICROSECONDS;
+    uint64_t next;
+    if (target) {
+        // one period after the last target, so that the interval is the period even when it changed
+        next = target + period;
+        if (next < earliest) next += (earliest - next + period - 1) / period * period;
+    } else {
+        // the first boundary after now that leaves enough time to sleep
+        next = earliest < phase ? phase : (earliest - phase + period - 1) / period * period + phase;
+    }
+
+    target = next;
+    ESP_LOGI(tag, "Awake for %llu ms, next wake at %llu ms", (unsigned long long)(now - woke_at) / 1000,
+             (unsigned long long)next / 1000);
+    return next - now - stats.boot_estimate_us;
+}
+
+Wake::Stats Wake::getStats() {
+    return stats;
+}
+
+double Wake::meanError(const Stats &stats) {
+    return stats.wakes ? (double)stats.error_sum_us / stats.wakes : 0;
+}
+
+double Wake::errorDeviation(const Stats &stats) {
+    if (!stats.wakes) return 0;
+
+    double mean = meanError(stats);
+    double variance = (double)stats.error_square_sum / stats.wakes - mean * mean;
+    return variance > 0 ? sqrt(variance) : 0;
+}
+
+void Wake::logStats() {
+    if (!stats.wakes) return;
+
+    ESP_LOGI(tag, "woke %lld us after target (mean %.0f us, standard deviation %.0f us, %lld..%lld us over %u wakes), "
+             "boot estimate %d us", (long long)stats.last_error_us, meanError(stats), errorDeviation(stats),
+             (long long)stats.min_error_us, (long long)stats.max_error_us, stats.wakes, stats.boot_estimate_us);
+}
@@ -0,0 +1,36 @@
+#ifndef WAKE_H
+#define WAKE_H
+
+#include <stdint.h>
+
+// Schedules deep sleep on the RTC clock, which keeps counting through deep
+// sleep. The first wake lands on a multiple of the period plus a per-device
+// phase, each following one a period after the previous target, also when
+// the period changes. Time spent awake does not shift the following wakes,
+// and the time from the wakeup timer to app_main is learned and slept less.
+namespace Wake {
+    struct Stats {
+        uint32_t wakes;         // timer wakes that had a target
+        int64_t last_error_us;  // app_main start minus target
+        int64_t min_error_us;
+        int64_t max_error_us;
+        int64_t error_sum_us;
+        uint64_t error_square_sum; // µs², for the standard deviation
+        int32_t boot_estimate_us;  // learned time from the wakeup timer to app_main
+    };
+
+    // to be called first thing in app_main
+    void begin();
+
+    // time to sleep until the next wake, at least a second away, a whole number of periods after the
+    // last target, the phase only applies to the first wake of a schedule
+    uint64_t sleepDuration(uint32_t period_milliseconds, uint32_t phase_milliseconds);
+
+    Stats getStats();
+    // of the wake error over stats.wakes, in µs
+    double meanError(const Stats &stats);
+    double errorDeviation(const Stats &stats);
+    void logStats();
+}
+
+#endif
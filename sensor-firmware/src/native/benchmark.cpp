@@ -0,0 +1,161 @@
+/*
+  Runs wake cycles of app_main on the host, against the BME280 simulator and
+  fakes of the ESP-IDF APIs used by the firmware.
+  Reports simulated time, I2C traffic and driver heap allocations per phase.
+  Bus and delay time are simulated, Bluetooth and NVS calls take no time.
+  Blocking waits count as idle time, which the CPU spends at the minimum
+  frequency or in light sleep, the rest of a phase runs at the maximum.
+  Waking from deep sleep takes a boot time with jitter, the summary at the end
+  shows how far wakes were off their target.
+  Tasks run to completion when they are created, so phases on different cores
+  do not overlap here.
+
+  Usage: pio run -e native && .pio/build/native/program [cycles] [-v] [-w] [-m aa:bb:cc:dd:ee:ff]
+  -w lets the temperature follow a slow daily wave instead of staying constant,
+  -m sets the MAC address the wake phase is derived from.
+  Batching is evaluated by adding e.g. -DBATCH_READINGS=5 to the build_flags,
+  change-triggered reporting with e.g. -DHEARTBEAT_CYCLES=15 and adaptive
+  periods with e.g. -DPERIOD_MAX_SECONDS=900.
+*/
+// the Unity tests in test/ are linked against src/ and bring their own main
+#ifndef PIO_UNIT_TESTING
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "adv_frame.h"
+#include "bme280_sim.h"
+#include "deadband.h"
+#include "fake.h"
+#include "phases.h"
+#include "power.h"
+#include "wake.h"
+
+extern "C" void app_main();
+
+// a room that is 2 °C warmer in the afternoon than at night
+static BME280Sim::Environment dailyWave(uint64_t time_us) {
+    const double day_us = 24 * 3600e6;
+    BME280Sim::Environment environment = { 21.5 + sin(2 * M_PI * time_us / day_us), 45.0, 101325.0 };
+    return environment;
+}
+
+static void printRow(const char *name, int core, int64_t start, int64_t duration, int64_t idle,
+                     const Fake::Counters &c) {
+    char core_name[12] = "-";
+    if (core >= 0) snprintf(core_name, sizeof(core_name), "%d", core);
+    printf("  %-12s %4s %9lld %9lld %9lld %6u %6u %6u %8llu %6u %7u\n", name, core_name, (long long)start,
+           (long long)duration, (long long)idle, c.cmd_begins, c.transactions, c.bus_bytes, (unsigned long long)c.bus_time_us,
+           c.allocations, c.allocated_bytes);
+}
+
+static void printData(const char *name, const uint8_t *data, uint8_t len) {
+    printf("  %s (%u B, %u us on air per channel):", name, len, AdvFrame::airtimeMicroseconds(len));
+    for (uint8_t i = 0; i < len; i++) printf(" %02x", data[i]);
+    printf("\n");
+}
+
+// tasks do not overlap here, so the idle time of both cores adds up along the simulated clock
+static uint32_t idleMicroseconds() {
+    return Power::idleMicroseconds(0) + Power::idleMicroseconds(1);
+}
+
+static void report(int cycle, uint64_t boot_time, uint32_t idle_at_boot) {
+    printf("cycle %d\n", cycle);
+    printf("  %-12s %4s %9s %9s %9s %6s %6s %6s %8s %6s %7s\n", "phase", "core", "start us", "took us",
+           "idle us", "cmds", "trans", "bytes", "bus us", "allocs", "alloc B");
+
+    Fake::Counters total = {};
+    for (int i = 0; i <= Phases::PHASE_COUNT; i++) {
+        Phases::Phase phase = (Phases::Phase)i;
+        const Fake::Counters &c = Fake::counters(phase);
+        bool ran = i < Phases::PHASE_COUNT && Phases::started(phase) >= (int64_t)boot_time;
+        if (!ran && c.cmd_begins == 0 && c.allocations == 0) continue;
+
+        if (ran) {
+            printRow(Phases::name(phase), Phases::core(phase), Phases::started(phase) - boot_time,
+                     Phases::duration(phase), Phases::idle(phase), c);
+        } else {
+            printRow(Phases::name(phase), -1, -1, 0, 0, c);
+        }
+
+        total.cmd_begins += c.cmd_begins;
+        total.transactions += c.transactions;
+        total.bus_bytes += c.bus_bytes;
+        total.bus_time_us += c.bus_time_us;
+        total.allocations += c.allocations;
+        total.allocated_bytes += c.allocated_bytes;
+    }
+    printRow("total", -1, 0, BME280Sim::now() - boot_time, idleMicroseconds() - idle_at_boot, total);
+
+    Power::Config power = Power::getConfig();
+    printf("  CPU at %u MHz while busy, idle at %u MHz%s\n", power.max_mhz, power.min_mhz,
+           power.light_sleep ? " or in light sleep" : "");
+
+    printf("  driver heap not freed: %u B\n", Fake::heapInUse());
+    printf("  deep sleep requested:  %llu us\n", (unsigned long long)Fake::deepSleepDuration());
+
+    uint8_t len;
+    const uint8_t *data;
+    for (uint8_t i = 0; i < Fake::advertisedFrameCount(); i++) {
+        data = Fake::advertisedFrame(i, &len);
+        printData("advertising data", data, len);
+    }
+    if (!Fake::advertisedFrameCount()) printf("  radio off\n");
+    else printf("  advertising interval: %.1f ms\n", Fake::advertisingInterval() * 0.625);
+    Deadband::Stats deadband = Deadband::getStats();
+    printf("  readings reported: %u, skipped: %u\n", deadband.reported, deadband.skipped);
+    Wake::Stats wake = Wake::getStats();
+    if (wake.wakes) printf("  woke %lld us after target\n", (long long)wake.last_error_us);
+    data = Fake::scanResponseData(&len);
+    if (len) printData("scan response", data, len);
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    int cycles = 1;
+    bool wave = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-v") == 0) {
+            Fake::setLogLevel(ESP_LOG_INFO);
+        } else if (strcmp(argv[i], "-w") == 0) {
+            wave = true;
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            unsigned int mac[6];
+            if (sscanf(argv[++i], "%x:%x:%x:%x:%x:%x", &mac[0], &mac[1], &mac[2], &mac[3], &mac[4], &mac[5]) != 6) {
+                fprintf(stderr, "invalid MAC address %s\n", argv[i]);
+                return 2;
+            }
+            uint8_t address[6];
+            for (int j = 0; j < 6; j++) address[j] = mac[j];
+            Fake::setMac(address);
+        } else {
+            cycles = atoi(argv[i]);
+        }
+    }
+
+    BME280Sim::reset();
+    if (wave) BME280Sim::setEnvironment(dailyWave);
+    for (int cycle = 1; cycle <= cycles; cycle++) {
+        Fake::reboot();
+        Fake::resetCounters();
+        uint64_t boot_time = BME280Sim::now();
+        uint32_t idle_at_boot = idleMicroseconds();
+
+        app_main();
+
+        report(cycle, boot_time, idle_at_boot);
+        BME280Sim::advance(Fake::deepSleepDuration());
+    }
+
+    Wake::Stats wake = Wake::getStats();
+    if (wake.wakes) {
+        printf("wake error over %u wakes: mean %.0f us, standard deviation %.0f us, %lld..%lld us\n", wake.wakes,
+               Wake::meanError(wake), Wake::errorDeviation(wake), (long long)wake.min_error_us,
+               (long long)wake.max_error_us);
+    }
+
+    return 0;
+}
+#endif
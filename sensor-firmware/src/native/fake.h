@@ -0,0 +1,52 @@
+#ifndef FAKE_H
+#define FAKE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "phases.h"
+
+// Instrumentation of the ESP-IDF fakes, used by the benchmark runner.
+// Time is the simulated time of the BME280 simulator.
+namespace Fake {
+    struct Counters {
+        uint32_t cmd_begins;      // calls to i2c_master_cmd_begin
+        uint32_t transactions;    // START ... STOP frames seen by the sensor
+        uint32_t bus_bytes;
+        uint64_t bus_time_us;
+        uint32_t allocations;     // heap allocations made inside driver calls
+        uint32_t allocated_bytes;
+    };
+
+    // forgets peripheral state, like an ESP32 waking up from deep sleep,
+    // which also takes a boot time with some jitter
+    void reboot();
+
+    void resetCounters();
+    Counters &counters(Phases::Phase phase); // PHASE_COUNT: outside of any phase
+    uint32_t heapInUse();                    // allocated by driver calls and not freed yet
+
+    void *allocate(size_t size);
+    void release(void *ptr);
+
+    // advances the simulated clock while the current core waits, counted as its idle time
+    void idle(uint64_t microseconds);
+
+    uint64_t deepSleepDuration(); // requested by the last call to esp_deep_sleep
+    void setMac(const uint8_t *address); // returned by esp_efuse_mac_get_default, 6 bytes
+    void setLogLevel(esp_log_level_t level);
+
+    // used by reboot()
+    void rebootI2C();
+    void rebootBluetooth();
+
+    bool advertising();
+    uint16_t advertisingInterval(); // 0.625 ms units, 0 if not configured since boot
+    // distinct advertising PDU payloads handed to the controller since boot, in order
+    uint8_t advertisedFrameCount();
+    const uint8_t *advertisedFrame(uint8_t index, uint8_t *len);
+    const uint8_t *scanResponseData(uint8_t *len);
+}
+
+#endif
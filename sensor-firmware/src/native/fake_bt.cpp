@@ -0,0 +1,288 @@
+#include "fake.h"
+
+#include <string.h>
+
+#include "esp_bt.h"
+#include "esp_bt_main.h"
+#include "esp_gap_ble_api.h"
+#include "hci.h"
+
+#define ADV_DATA_MAX_LEN 31
+
+static bool classic_released;
+static esp_bt_controller_status_t controller_status;
+static bool bluedroid_initialized;
+static bool bluedroid_enabled;
+static bool is_advertising;
+static uint16_t adv_interval;
+static const esp_vhci_host_callback_t *vhci_callback;
+static esp_gap_ble_cb_t gap_callback;
+
+static char device_name[32];
+static uint8_t adv_data[ADV_DATA_MAX_LEN];
+static uint8_t adv_data_len;
+static uint8_t scan_rsp_data[ADV_DATA_MAX_LEN];
+static uint8_t scan_rsp_data_len;
+
+// distinct advertising data handed to the controller since boot
+#define MAX_FRAMES 16
+static uint8_t frames[MAX_FRAMES][ADV_DATA_MAX_LEN];
+static uint8_t frame_lengths[MAX_FRAMES];
+static uint8_t frame_count;
+
+static void recordFrame() {
+    for (uint8_t i = 0; i < frame_count; i++) {
+        if (frame_lengths[i] == adv_data_len && !memcmp(frames[i], adv_data, adv_data_len)) return;
+    }
+
+    if (frame_count == MAX_FRAMES) return;
+    memcpy(frames[frame_count], adv_data, adv_data_len);
+    frame_lengths[frame_count++] = adv_data_len;
+}
+
+// appends an AD structure, Bluedroid silently drops what does not fit
+static void appendStructure(uint8_t type, const uint8_t *data, uint8_t len) {
+    if (adv_data_len + 2 + len > ADV_DATA_MAX_LEN) return;
+
+    adv_data[adv_data_len++] = len + 1;
+    adv_data[adv_data_len++] = type;
+    memcpy(&adv_data[adv_data_len], data, len);
+    adv_data_len += len;
+}
+
+void Fake::rebootBluetooth() {
+    classic_released = false;
+    controller_status = ESP_BT_CONTROLLER_STATUS_IDLE;
+    bluedroid_initialized = false;
+    bluedroid_enabled = false;
+    is_advertising = false;
+    adv_interval = 0;
+    adv_data_len = 0;
+    scan_rsp_data_len = 0;
+    frame_count = 0;
+    vhci_callback = NULL;
+    gap_callback = NULL;
+}
+
+static void gapEvent(esp_gap_ble_cb_event_t event) {
+    if (!gap_callback) return;
+
+    esp_ble_gap_cb_param_t param = {};
+    gap_callback(event, &param);
+}
+
+bool Fake::advertising() {
+    return is_advertising;
+}
+
+uint16_t Fake::advertisingInterval() {
+    return adv_interval;
+}
+
+uint8_t Fake::advertisedFrameCount() {
+    return frame_count;
+}
+
+const uint8_t *Fake::advertisedFrame(uint8_t index, uint8_t *len) {
+    *len = frame_lengths[index];
+    return frames[index];
+}
+
+const uint8_t *Fake::scanResponseData(uint8_t *len) {
+    *len = scan_rsp_data_len;
+    return scan_rsp_data;
+}
+
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode) {
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_IDLE) return ESP_ERR_INVALID_STATE;
+
+    if (mode & ESP_BT_MODE_CLASSIC_BT) classic_released = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *cfg) {
+    if (!cfg) return ESP_ERR_INVALID_ARG;
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_IDLE) return ESP_ERR_INVALID_STATE;
+
+    controller_status = ESP_BT_CONTROLLER_STATUS_INITED;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_deinit() {
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_INITED) return ESP_ERR_INVALID_STATE;
+
+    controller_status = ESP_BT_CONTROLLER_STATUS_IDLE;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_enable(esp_bt_mode_t mode) {
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_INITED) return ESP_ERR_INVALID_STATE;
+    if ((mode & ESP_BT_MODE_CLASSIC_BT) && classic_released) return ESP_ERR_INVALID_ARG;
+
+    controller_status = ESP_BT_CONTROLLER_STATUS_ENABLED;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_disable() {
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_ENABLED) return ESP_ERR_INVALID_STATE;
+
+    controller_status = ESP_BT_CONTROLLER_STATUS_INITED;
+    is_advertising = false;
+    return ESP_OK;
+}
+
+esp_bt_controller_status_t esp_bt_controller_get_status() {
+    return controller_status;
+}
+
+esp_err_t esp_bluedroid_init() {
+    if (controller_status != ESP_BT_CONTROLLER_STATUS_ENABLED || bluedroid_initialized) return ESP_ERR_INVALID_STATE;
+
+    bluedroid_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_enable() {
+    if (!bluedroid_initialized || bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+
+    bluedroid_enabled = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_disable() {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+
+    bluedroid_enabled = false;
+    is_advertising = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_deinit() {
+    if (!bluedroid_initialized || bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+
+    bluedroid_initialized = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_register_callback(esp_gap_ble_cb_t callback) {
+    gap_callback = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_set_device_name(const char *name) {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+    if (!name || strlen(name) >= sizeof(device_name)) return ESP_ERR_INVALID_ARG;
+
+    strcpy(device_name, name);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_config_adv_data(esp_ble_adv_data_t *data) {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+    if (!data) return ESP_ERR_INVALID_ARG;
+
+    adv_data_len = 0;
+    if (data->flag) appendStructure(0x01, &data->flag, 1);
+    if (data->include_name) appendStructure(0x09, (const uint8_t *)device_name, strlen(device_name));
+    if (data->manufacturer_len) appendStructure(0xFF, data->p_manufacturer_data, data->manufacturer_len);
+    recordFrame();
+    gapEvent(ESP_GAP_BLE_ADV_DATA_SET_COMPLETE_EVT);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_config_adv_data_raw(uint8_t *raw_data, uint32_t raw_data_len) {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+    if (!raw_data || raw_data_len > ADV_DATA_MAX_LEN) return ESP_ERR_INVALID_ARG;
+
+    memcpy(adv_data, raw_data, raw_data_len);
+    adv_data_len = raw_data_len;
+    recordFrame();
+    gapEvent(ESP_GAP_BLE_ADV_DATA_RAW_SET_COMPLETE_EVT);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_config_scan_rsp_data_raw(uint8_t *raw_data, uint32_t raw_data_len) {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+    if (!raw_data || raw_data_len > ADV_DATA_MAX_LEN) return ESP_ERR_INVALID_ARG;
+
+    memcpy(scan_rsp_data, raw_data, raw_data_len);
+    scan_rsp_data_len = raw_data_len;
+    gapEvent(ESP_GAP_BLE_SCAN_RSP_DATA_RAW_SET_COMPLETE_EVT);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_start_advertising(esp_ble_adv_params_t *adv_params) {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+    if (!adv_params || adv_params->adv_int_min > adv_params->adv_int_max) return ESP_ERR_INVALID_ARG;
+
+    adv_interval = adv_params->adv_int_min;
+    is_advertising = true;
+    gapEvent(ESP_GAP_BLE_ADV_START_COMPLETE_EVT);
+    return ESP_OK;
+}
+
+esp_err_t esp_ble_gap_stop_advertising() {
+    if (!bluedroid_enabled) return ESP_ERR_INVALID_STATE;
+
+    is_advertising = false;
+    gapEvent(ESP_GAP_BLE_ADV_STOP_COMPLETE_EVT);
+    return ESP_OK;
+}
+
+esp_err_t esp_vhci_host_register_callback(const esp_vhci_host_callback_t *callback) {
+    vhci_callback = callback;
+    return ESP_OK;
+}
+
+bool esp_vhci_host_check_send_available() {
+    return controller_status == ESP_BT_CONTROLLER_STATUS_ENABLED;
+}
+
+// error codes from Bluetooth Core Spec Vol 1 Part F
+#define HCI_SUCCESS 0x00
+#define HCI_UNKNOWN_COMMAND 0x01
+#define HCI_COMMAND_DISALLOWED 0x0C
+#define HCI_INVALID_PARAMETERS 0x12
+
+static uint8_t execute(uint16_t opcode, const uint8_t *parameters, uint8_t len) {
+    switch (opcode) {
+    case HCI::LE_SET_ADV_PARAMS: {
+        if (len != 15) return HCI_INVALID_PARAMETERS;
+        uint16_t interval_min = parameters[0] | (parameters[1] << 8);
+        uint16_t interval_max = parameters[2] | (parameters[3] << 8);
+        if (interval_min > interval_max || interval_min < 0x20) return HCI_INVALID_PARAMETERS;
+        if (is_advertising) return HCI_COMMAND_DISALLOWED;
+        adv_interval = interval_min;
+        return HCI_SUCCESS;
+    }
+    case HCI::LE_SET_ADV_DATA:
+        if (len != 32 || parameters[0] > ADV_DATA_MAX_LEN) return HCI_INVALID_PARAMETERS;
+        adv_data_len = parameters[0];
+        memcpy(adv_data, parameters + 1, adv_data_len);
+        recordFrame();
+        return HCI_SUCCESS;
+    case HCI::LE_SET_SCAN_RESPONSE_DATA:
+        if (len != 32 || parameters[0] > ADV_DATA_MAX_LEN) return HCI_INVALID_PARAMETERS;
+        scan_rsp_data_len = parameters[0];
+        memcpy(scan_rsp_data, parameters + 1, scan_rsp_data_len);
+        return HCI_SUCCESS;
+    case HCI::LE_SET_ADV_ENABLE:
+        if (len != 1 || parameters[0] > 1) return HCI_INVALID_PARAMETERS;
+        is_advertising = parameters[0];
+        return HCI_SUCCESS;
+    default:
+        return HCI_UNKNOWN_COMMAND;
+    }
+}
+
+void esp_vhci_host_send_packet(uint8_t *data, uint16_t len) {
+    if (!data || len < 4 || data[0] != HCI::COMMAND_PACKET || len != 4 + data[3]) return;
+
+    uint16_t opcode = data[1] | (data[2] << 8);
+    uint8_t status = controller_status == ESP_BT_CONTROLLER_STATUS_ENABLED
+                     ? execute(opcode, data + 4, data[3]) : HCI_COMMAND_DISALLOWED;
+
+    uint8_t event[] = { HCI::EVENT_PACKET, HCI::COMMAND_COMPLETE_EVENT, 4, 1,
+                        (uint8_t)(opcode & 0xFF), (uint8_t)(opcode >> 8), status };
+    if (vhci_callback && vhci_callback->notify_host_recv) vhci_callback->notify_host_recv(event, sizeof(event));
+}
@@ -0,0 +1,81 @@
+#include "fake.h"
+
+#include "bme280_sim.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+// There is no scheduler: created tasks run to completion right away. The
+// simulated clock keeps counting, so phases of a pinned task show up as
+// sequential rather than overlapping in the benchmark.
+
+struct EventGroup {
+    EventBits_t bits;
+};
+
+static BaseType_t current_core = 0;
+static uint32_t idle_time[2]; // µs per core, wraps around like the run time counter
+
+void Fake::idle(uint64_t microseconds) {
+    BME280Sim::advance(microseconds);
+    idle_time[current_core] += microseconds;
+}
+
+extern "C" BaseType_t xPortGetCoreID() {
+    return current_core;
+}
+
+extern "C" BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char *, uint32_t, void *parameters,
+                                              UBaseType_t, TaskHandle_t *created_task, BaseType_t core_id) {
+    if (created_task) *created_task = NULL;
+
+    BaseType_t creator_core = current_core;
+    current_core = core_id == tskNO_AFFINITY ? creator_core : core_id;
+    task_code(parameters);
+    current_core = creator_core;
+
+    return pdPASS;
+}
+
+extern "C" void vTaskDelete(TaskHandle_t) {
+}
+
+extern "C" EventGroupHandle_t xEventGroupCreate() {
+    return new EventGroup();
+}
+
+extern "C" void vEventGroupDelete(EventGroupHandle_t event_group) {
+    delete event_group;
+}
+
+extern "C" EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, const EventBits_t bits_to_set) {
+    event_group->bits |= bits_to_set;
+    return event_group->bits;
+}
+
+extern "C" EventBits_t xEventGroupClearBits(EventGroupHandle_t event_group, const EventBits_t bits_to_clear) {
+    EventBits_t bits = event_group->bits;
+    event_group->bits &= ~bits_to_clear;
+    return bits;
+}
+
+extern "C" EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, const EventBits_t bits_to_wait_for,
+                                           const BaseType_t clear_on_exit, const BaseType_t wait_for_all_bits,
+                                           TickType_t) {
+    EventBits_t bits = event_group->bits;
+    bool satisfied = wait_for_all_bits ? (bits & bits_to_wait_for) == bits_to_wait_for : (bits & bits_to_wait_for);
+    if (satisfied && clear_on_exit) event_group->bits &= ~bits_to_wait_for;
+
+    return bits;
+}
+
+extern "C" TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuid) {
+    return &idle_time[cpuid];
+}
+
+extern "C" void vTaskGetInfo(TaskHandle_t task, TaskStatus_t *task_status, BaseType_t, eTaskState state) {
+    task_status->xHandle = task;
+    task_status->eCurrentState = state;
+    task_status->ulRunTimeCounter = *(uint32_t *)task;
+}
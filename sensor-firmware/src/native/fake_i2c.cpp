@@ -0,0 +1,211 @@
+#include "fake.h"
+
+#include "bme280_sim.h"
+#include "driver/i2c.h"
+
+enum CommandType { CMD_START, CMD_WRITE, CMD_READ, CMD_STOP };
+
+// like the ESP-IDF driver, every queued command is a separate heap allocation,
+// unless the link was created in a static buffer
+struct Command {
+    CommandType type;
+    uint8_t byte;
+    const uint8_t *write_data;
+    uint8_t *read_data;
+    size_t len;
+    bool ack_en;
+    i2c_ack_type_t ack;
+    Command *next;
+};
+
+struct CommandLink {
+    Command *head;
+    Command *tail;
+    uint8_t *free;  // remaining space of a static link, NULL for heap links
+    size_t free_size;
+};
+
+static_assert(sizeof(Command) <= I2C_INTERNAL_STRUCT_SIZE, "I2C_INTERNAL_STRUCT_SIZE too small");
+static_assert(sizeof(CommandLink) <= I2C_INTERNAL_STRUCT_SIZE, "I2C_INTERNAL_STRUCT_SIZE too small");
+
+static bool configured[I2C_NUM_MAX];
+static bool installed[I2C_NUM_MAX];
+
+static esp_err_t append(i2c_cmd_handle_t cmd_handle, const Command& command) {
+    if (!cmd_handle) return ESP_ERR_INVALID_ARG;
+
+    CommandLink *link = (CommandLink *)cmd_handle;
+    Command *node;
+    if (link->free) {
+        if (link->free_size < I2C_INTERNAL_STRUCT_SIZE) return ESP_ERR_NO_MEM;
+        node = (Command *)link->free;
+        link->free += I2C_INTERNAL_STRUCT_SIZE;
+        link->free_size -= I2C_INTERNAL_STRUCT_SIZE;
+    } else {
+        node = (Command *)Fake::allocate(sizeof(Command));
+    }
+    *node = command;
+    node->next = NULL;
+    if (link->tail) {
+        link->tail->next = node;
+    } else {
+        link->head = node;
+    }
+    link->tail = node;
+
+    return ESP_OK;
+}
+
+static esp_err_t execute(const Command *command) {
+    switch (command->type) {
+    case CMD_START:
+        BME280Sim::busStart();
+        return ESP_OK;
+    case CMD_WRITE:
+        for (size_t i = 0; i < command->len; i++) {
+            uint8_t byte = command->write_data ? command->write_data[i] : command->byte;
+            if (!BME280Sim::busWrite(byte) && command->ack_en) return ESP_FAIL;
+        }
+        return ESP_OK;
+    case CMD_READ:
+        for (size_t i = 0; i < command->len; i++) {
+            bool last = i + 1 == command->len;
+            bool ack = command->ack == I2C_MASTER_ACK || (command->ack == I2C_MASTER_LAST_NACK && !last);
+            command->read_data[i] = BME280Sim::busRead(ack);
+        }
+        return ESP_OK;
+    case CMD_STOP:
+        BME280Sim::busStop();
+        return ESP_OK;
+    }
+
+    return ESP_FAIL;
+}
+
+void Fake::rebootI2C() {
+    for (int i = 0; i < I2C_NUM_MAX; i++) {
+        configured[i] = false;
+        installed[i] = false;
+    }
+}
+
+esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf) {
+    if (i2c_num >= I2C_NUM_MAX || !i2c_conf) return ESP_ERR_INVALID_ARG;
+
+    BME280Sim::setClockSpeed(i2c_conf->master.clk_speed);
+    configured[i2c_num] = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_install(i2c_port_t i2c_num, i2c_mode_t, size_t, size_t, int) {
+    if (i2c_num >= I2C_NUM_MAX) return ESP_ERR_INVALID_ARG;
+    if (installed[i2c_num]) return ESP_FAIL;
+
+    installed[i2c_num] = true;
+    return ESP_OK;
+}
+
+esp_err_t i2c_driver_delete(i2c_port_t i2c_num) {
+    if (i2c_num >= I2C_NUM_MAX || !installed[i2c_num]) return ESP_ERR_INVALID_ARG;
+
+    installed[i2c_num] = false;
+    return ESP_OK;
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create() {
+    return Fake::allocate(sizeof(CommandLink));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd_handle) {
+    if (!cmd_handle) return;
+
+    Command *command = ((CommandLink *)cmd_handle)->head;
+    while (command) {
+        Command *next = command->next;
+        Fake::release(command);
+        command = next;
+    }
+    Fake::release(cmd_handle);
+}
+
+i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t *buffer, uint32_t size) {
+    if (!buffer || size < 2 * I2C_INTERNAL_STRUCT_SIZE) return NULL;
+
+    CommandLink *link = (CommandLink *)buffer;
+    *link = CommandLink();
+    link->free = buffer + I2C_INTERNAL_STRUCT_SIZE;
+    link->free_size = size - I2C_INTERNAL_STRUCT_SIZE;
+    return link;
+}
+
+void i2c_cmd_link_delete_static(i2c_cmd_handle_t) {
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd_handle) {
+    Command command = {};
+    command.type = CMD_START;
+    return append(cmd_handle, command);
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd_handle, uint8_t data, bool ack_en) {
+    Command command = {};
+    command.type = CMD_WRITE;
+    command.byte = data;
+    command.len = 1;
+    command.ack_en = ack_en;
+    return append(cmd_handle, command);
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd_handle, const uint8_t *data, size_t data_len, bool ack_en) {
+    if (!data) return ESP_ERR_INVALID_ARG;
+
+    Command command = {};
+    command.type = CMD_WRITE;
+    command.write_data = data;
+    command.len = data_len;
+    command.ack_en = ack_en;
+    return append(cmd_handle, command);
+}
+
+esp_err_t i2c_master_read_byte(i2c_cmd_handle_t cmd_handle, uint8_t *data, i2c_ack_type_t ack) {
+    return i2c_master_read(cmd_handle, data, 1, ack);
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd_handle, uint8_t *data, size_t data_len, i2c_ack_type_t ack) {
+    if (!data || data_len == 0) return ESP_ERR_INVALID_ARG;
+
+    Command command = {};
+    command.type = CMD_READ;
+    command.read_data = data;
+    command.len = data_len;
+    command.ack = ack;
+    return append(cmd_handle, command);
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd_handle) {
+    Command command = {};
+    command.type = CMD_STOP;
+    return append(cmd_handle, command);
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle, TickType_t) {
+    if (i2c_num >= I2C_NUM_MAX || !cmd_handle) return ESP_ERR_INVALID_ARG;
+    if (!configured[i2c_num] || !installed[i2c_num]) return ESP_ERR_INVALID_STATE;
+
+    BME280Sim::Stats before = BME280Sim::getStats();
+
+    esp_err_t result = ESP_OK;
+    for (Command *command = ((CommandLink *)cmd_handle)->head; command && result == ESP_OK; command = command->next) {
+        result = execute(command);
+    }
+    if (result != ESP_OK) BME280Sim::busStop();
+
+    BME280Sim::Stats after = BME280Sim::getStats();
+    Fake::Counters &counters = Fake::counters(Phases::current());
+    counters.cmd_begins++;
+    counters.transactions += after.transactions - before.transactions;
+    counters.bus_bytes += after.bytes - before.bytes;
+    counters.bus_time_us += after.bus_time_us - before.bus_time_us;
+
+    return result;
+}
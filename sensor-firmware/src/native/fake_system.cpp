@@ -0,0 +1,250 @@
+#include "fake.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bme280_sim.h"
+#include "esp_clk.h"
+#include "esp_err.h"
+#include "esp_pm.h"
+#include "esp_sleep.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/task.h"
+#include "nvs_flash.h"
+#include "rom/ets_sys.h"
+
+static esp_log_level_t log_level = ESP_LOG_WARN;
+static uint64_t deep_sleep_duration;
+static uint64_t timer_wakeup;
+static esp_sleep_wakeup_cause_t wakeup_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+
+// from the wakeup timer to app_main: ROM, bootloader and image loading
+#define BOOT_MICROSECONDS 160000
+#define BOOT_JITTER_MICROSECONDS 40000
+static uint32_t boot_random = 1;
+static uint32_t random_state = 2463534242u;
+static uint8_t mac[6] = { 0x24, 0x0a, 0xc4, 0x12, 0x34, 0x56 };
+
+static Fake::Counters phase_counters[Phases::PHASE_COUNT + 1];
+static uint32_t heap_in_use;
+#define HEAP_SIZE 300000
+
+struct esp_timer {
+    esp_timer_create_args_t args;
+    bool armed;
+    uint64_t expiry;
+};
+
+static uint32_t notifications;
+
+void Fake::reboot() {
+    wakeup_cause = deep_sleep_duration ? ESP_SLEEP_WAKEUP_TIMER : ESP_SLEEP_WAKEUP_UNDEFINED;
+    if (wakeup_cause == ESP_SLEEP_WAKEUP_TIMER) {
+        boot_random = boot_random * 1103515245 + 12345;
+        BME280Sim::advance(BOOT_MICROSECONDS + (boot_random >> 8) % BOOT_JITTER_MICROSECONDS);
+    }
+    deep_sleep_duration = 0;
+    heap_in_use = 0;
+    timer_wakeup = 0;
+    notifications = 0;
+    rebootI2C();
+    rebootBluetooth();
+}
+
+void Fake::resetCounters() {
+    memset(phase_counters, 0, sizeof(phase_counters));
+}
+
+Fake::Counters &Fake::counters(Phases::Phase phase) {
+    return phase_counters[phase];
+}
+
+uint32_t Fake::heapInUse() {
+    return heap_in_use;
+}
+
+extern "C" uint32_t esp_get_free_heap_size() {
+    return HEAP_SIZE - heap_in_use;
+}
+
+void Fake::setMac(const uint8_t *address) {
+    memcpy(mac, address, sizeof(mac));
+}
+
+extern "C" esp_err_t esp_efuse_mac_get_default(uint8_t *address) {
+    memcpy(address, mac, sizeof(mac));
+    return ESP_OK;
+}
+
+extern "C" uint32_t esp_random() {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+void *Fake::allocate(size_t size) {
+    Counters &phase = counters(Phases::current());
+    phase.allocations++;
+    phase.allocated_bytes += size;
+    heap_in_use += size;
+
+    size_t *block = (size_t *)calloc(1, sizeof(size_t) + size);
+    *block = size;
+    return block + 1;
+}
+
+void Fake::release(void *ptr) {
+    if (!ptr) return;
+
+    size_t *block = (size_t *)ptr - 1;
+    heap_in_use -= *block;
+    free(block);
+}
+
+uint64_t Fake::deepSleepDuration() {
+    return deep_sleep_duration;
+}
+
+void Fake::setLogLevel(esp_log_level_t level) {
+    log_level = level;
+}
+
+extern "C" void esp_log_write(esp_log_level_t level, const char *, const char *format, ...) {
+    if (level > log_level) return;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(stderr, format, args);
+    va_end(args);
+}
+
+extern "C" const char *esp_err_to_name(esp_err_t code) {
+    switch (code) {
+    case ESP_OK: return "ESP_OK";
+    case ESP_FAIL: return "ESP_FAIL";
+    case ESP_ERR_NO_MEM: return "ESP_ERR_NO_MEM";
+    case ESP_ERR_INVALID_ARG: return "ESP_ERR_INVALID_ARG";
+    case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+    case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+    case ESP_ERR_TIMEOUT: return "ESP_ERR_TIMEOUT";
+    default: return "UNKNOWN ERROR";
+    }
+}
+
+extern "C" int64_t esp_timer_get_time() {
+    return BME280Sim::now();
+}
+
+extern "C" uint64_t esp_clk_rtc_time() {
+    return BME280Sim::now();
+}
+
+extern "C" void vTaskDelay(const TickType_t ticks) {
+    Fake::idle((uint64_t)ticks * portTICK_PERIOD_MS * 1000);
+}
+
+extern "C" void ets_delay_us(uint32_t us) {
+    BME280Sim::advance(us);
+}
+
+// only one timer can be armed at a time, which is all the firmware needs
+static esp_timer *armed_timer;
+
+extern "C" esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle) {
+    esp_timer *timer = new esp_timer();
+    timer->args = *create_args;
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    if (timer->armed || armed_timer) return ESP_ERR_INVALID_STATE;
+
+    timer->armed = true;
+    timer->expiry = BME280Sim::now() + timeout_us;
+    armed_timer = timer;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    if (!timer->armed) return ESP_ERR_INVALID_STATE;
+
+    timer->armed = false;
+    armed_timer = NULL;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    if (timer->armed) return ESP_ERR_INVALID_STATE;
+
+    delete timer;
+    return ESP_OK;
+}
+
+extern "C" TaskHandle_t xTaskGetCurrentTaskHandle() {
+    return &notifications;
+}
+
+extern "C" BaseType_t xTaskNotifyGive(TaskHandle_t) {
+    notifications++;
+    return pdPASS;
+}
+
+extern "C" uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait) {
+    if (!notifications && armed_timer && ticks_to_wait) {
+        esp_timer *timer = armed_timer;
+        Fake::idle(timer->expiry - BME280Sim::now());
+        timer->armed = false;
+        armed_timer = NULL;
+        timer->args.callback(timer->args.arg);
+    }
+
+    uint32_t count = notifications;
+    if (count) notifications = clear_count_on_exit ? 0 : count - 1;
+    return count;
+}
+
+extern "C" esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us) {
+    timer_wakeup = time_in_us;
+    return ESP_OK;
+}
+
+extern "C" esp_err_t esp_light_sleep_start() {
+    if (!timer_wakeup) return ESP_ERR_INVALID_STATE;
+
+    Fake::idle(timer_wakeup);
+    return ESP_OK;
+}
+
+extern "C" void esp_deep_sleep(uint64_t time_in_us) {
+    deep_sleep_duration = time_in_us;
+}
+
+extern "C" esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() {
+    return wakeup_cause;
+}
+
+extern "C" esp_err_t esp_pm_configure(const void *config) {
+    const esp_pm_config_esp32_t *pm_config = (const esp_pm_config_esp32_t *)config;
+    if (!pm_config) return ESP_ERR_INVALID_ARG;
+
+    int max = pm_config->max_freq_mhz, min = pm_config->min_freq_mhz;
+    if ((max != 80 && max != 160 && max != 240) || min < CONFIG_ESP32_XTAL_FREQ || min > max) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (pm_config->light_sleep_enable && !CONFIG_FREERTOS_USE_TICKLESS_IDLE) return ESP_ERR_NOT_SUPPORTED;
+
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_flash_init() {
+    return ESP_OK;
+}
+
+extern "C" esp_err_t nvs_flash_erase() {
+    return ESP_OK;
+}
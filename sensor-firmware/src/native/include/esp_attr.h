@@ -0,0 +1,9 @@
+#ifndef FAKE_ESP_ATTR_H
+#define FAKE_ESP_ATTR_H
+
+// there is no RTC memory on the host, statics keep their values between wake cycles anyway
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define IRAM_ATTR
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef FAKE_ESP_CLK_H
+#define FAKE_ESP_CLK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// microseconds of simulated time, which like the RTC keeps counting through deep sleep
+uint64_t esp_clk_rtc_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef FAKE_ESP_SLEEP_H
+#define FAKE_ESP_SLEEP_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER
+} esp_sleep_wakeup_cause_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ESP_SLEEP_WAKEUP_TIMER if the previous cycle went to deep sleep
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+// records the requested duration and returns, see Fake::deepSleepDuration
+void esp_deep_sleep(uint64_t time_in_us);
+
+// light sleep advances the simulated clock to the timer wakeup
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_light_sleep_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef FAKE_ESP_SYSTEM_H
+#define FAKE_ESP_SYSTEM_H
+
+#include "esp_err.h"
+#include "esp_sleep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// a nominal heap size minus what fakes allocated through Fake::allocate
+uint32_t esp_get_free_heap_size(void);
+
+// a fixed address, see Fake::setMac
+esp_err_t esp_efuse_mac_get_default(uint8_t *mac);
+// pseudo random, the same sequence on every run
+uint32_t esp_random(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef FAKE_FREERTOS_EVENT_GROUPS_H
+#define FAKE_FREERTOS_EVENT_GROUPS_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct EventGroup *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+EventGroupHandle_t xEventGroupCreate(void);
+void vEventGroupDelete(EventGroupHandle_t event_group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t event_group, const EventBits_t bits_to_set);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t event_group, const EventBits_t bits_to_clear);
+// as tasks run to completion when they are created, waiting never blocks and
+// returns the bits that are set
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t event_group, const EventBits_t bits_to_wait_for,
+                                const BaseType_t clear_on_exit, const BaseType_t wait_for_all_bits,
+                                TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef FAKE_FREERTOS_TASK_H
+#define FAKE_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+typedef enum {
+    eRunning,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid
+} eTaskState;
+
+typedef struct {
+    TaskHandle_t xHandle;
+    eTaskState eCurrentState;
+    uint32_t ulRunTimeCounter; // µs
+} TaskStatus_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// advances the simulated clock, there is no scheduler
+void vTaskDelay(const TickType_t ticks);
+
+// there is a single task, waiting for a notification advances the simulated
+// clock to the next armed esp_timer and runs its callback
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+uint32_t ulTaskNotifyTake(BaseType_t clear_count_on_exit, TickType_t ticks_to_wait);
+
+// runs the task to completion before returning, on the simulated clock of the caller
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t task_code, const char *name, uint32_t stack_depth,
+                                   void *parameters, UBaseType_t priority, TaskHandle_t *created_task,
+                                   BaseType_t core_id);
+void vTaskDelete(TaskHandle_t task);
+
+// the idle task of a core runs whenever the simulated clock advances in
+// vTaskDelay or other blocking waits on that core, see Fake::idle
+TaskHandle_t xTaskGetIdleTaskHandleForCPU(UBaseType_t cpuid);
+void vTaskGetInfo(TaskHandle_t task, TaskStatus_t *task_status, BaseType_t get_free_stack_space, eTaskState state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef FAKE_ROM_ETS_SYS_H
+#define FAKE_ROM_ETS_SYS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// advances the simulated clock
+void ets_delay_us(uint32_t us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef FAKE_SDKCONFIG_H
+#define FAKE_SDKCONFIG_H
+
+// the options of the sdkconfig (see sdkconfig.defaults) that the firmware reads
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ 160
+#define CONFIG_ESP32_XTAL_FREQ 40
+#define CONFIG_PM_ENABLE 1
+#define CONFIG_FREERTOS_USE_TICKLESS_IDLE 1
+#define CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS 1
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef BME280_FIXTURE_H_
+#define BME280_FIXTURE_H_
+
+/*
+  Calibrations and random raw values shared by the BME280 test suites and the
+  compensation benchmarks. Header only, each program gets its own copy.
+*/
+#include "bme280.h"
+#include "xorshift.h"
+
+/* T1..T3, P1..P9, H1..H6 of real chips, without derived coefficients */
+static const struct bme280_calib_data calibrations[] = {
+    { 27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000, 75, 362, 0, 324, 50, 30, 0, { 0 } },
+    { 28485, 26735, 50, 38123, -10624, 3024, 7895, -168, -7, 9900, -10230, 4285, 75, 359, 0, 336, 50, 30, 0, { 0 } },
+    { 27967, 26431, 50, 36538, -10605, 3024, 6793, -47, -7, 9900, -10230, 4285, 75, 370, 0, 301, 50, 30, 0, { 0 } },
+};
+#define CALIBRATIONS (sizeof(calibrations) / sizeof(calibrations[0]))
+
+#endif
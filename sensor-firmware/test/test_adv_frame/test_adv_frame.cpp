@@ -0,0 +1,84 @@
+#include "adv_frame.h"
+
+#include <string.h>
+#include <unity.h>
+
+// manufacturer specific data behind the length byte: AD type, company ID 0xFFFF
+#define HEADER 0xFF, 0xFF, 0xFF
+
+void setUp() {
+}
+
+void tearDown() {
+}
+
+static void test_header_only() {
+    const uint8_t none[1] = { 0 };
+    const uint8_t expected[] = { 3, HEADER };
+
+    AdvFrame::update(none, 0);
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), AdvFrame::length());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, AdvFrame::data(), sizeof(expected));
+}
+
+static void test_update_appends_payload() {
+    const uint8_t payload[] = { 0x81, 0x0F, 0x2E, 0xFB, 0xD7, 0x11, 0x94, 0x27, 0x01, 0x00 };
+    const uint8_t expected[] = { 13, HEADER, 0x81, 0x0F, 0x2E, 0xFB, 0xD7, 0x11, 0x94, 0x27, 0x01, 0x00 };
+
+    AdvFrame::update(payload, sizeof(payload));
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), AdvFrame::length());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, AdvFrame::data(), sizeof(expected));
+}
+
+static void test_update_patches_in_place() {
+    const uint8_t first[] = { 0x81, 0x09, 0x2E, 0xFB, 0x01, 0x00 };
+    const uint8_t second[] = { 0x81, 0x01, 0x30, 0xFB };
+    const uint8_t expected[] = { 7, HEADER, 0x81, 0x01, 0x30, 0xFB };
+
+    AdvFrame::update(first, sizeof(first));
+    const uint8_t *data = AdvFrame::data();
+    AdvFrame::update(second, sizeof(second));
+
+    // the same buffer, with the length and the reading bytes replaced
+    TEST_ASSERT_EQUAL_PTR(data, AdvFrame::data());
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), AdvFrame::length());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, AdvFrame::data(), sizeof(expected));
+}
+
+static void test_update_truncates() {
+    uint8_t payload[PAYLOAD_MAX_FRAME_SIZE + 1];
+    for (uint8_t i = 0; i < sizeof(payload); i++) payload[i] = i;
+
+    AdvFrame::update(payload, sizeof(payload));
+    // fills the 31 bytes of advertising data exactly
+    TEST_ASSERT_EQUAL_UINT8(31, AdvFrame::length());
+    TEST_ASSERT_EQUAL_UINT8(30, AdvFrame::data()[0]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(payload, AdvFrame::data() + 4, PAYLOAD_MAX_FRAME_SIZE);
+}
+
+static void test_scan_response() {
+    const uint8_t expected[] = { 10, 0x09, 'N', 'N', ' ', 'S', 'e', 'n', 's', 'o', 'r' };
+
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), AdvFrame::scanResponseLength());
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, AdvFrame::scanResponse(), sizeof(expected));
+    // built once, unaffected by updates of the advertising data
+    AdvFrame::update(expected, sizeof(expected));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, AdvFrame::scanResponse(), sizeof(expected));
+}
+
+static void test_airtime() {
+    // 16 bytes of overhead and the advertising data, at 8 µs per byte
+    TEST_ASSERT_EQUAL_UINT32(248, AdvFrame::airtimeMicroseconds(15));
+    TEST_ASSERT_EQUAL_UINT32(376, AdvFrame::airtimeMicroseconds(31));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_header_only);
+    RUN_TEST(test_update_appends_payload);
+    RUN_TEST(test_update_patches_in_place);
+    RUN_TEST(test_update_truncates);
+    RUN_TEST(test_scan_response);
+    RUN_TEST(test_airtime);
+    return UNITY_END();
+}
@@ -0,0 +1,144 @@
+#include "bme280.h"
+#include "../bme280_fixture.h"
+
+#include <string.h>
+#include <unity.h>
+
+#ifdef BME280_FLOAT_ENABLE
+typedef double pressure_t;
+typedef double temperature_t;
+typedef double humidity_t;
+#else
+typedef uint32_t pressure_t;
+typedef int32_t temperature_t;
+typedef uint32_t humidity_t;
+#endif
+
+/* not a multiple of the batch block length, so that the last block is a partial one */
+#define SAMPLES 4095
+
+static uint32_t press[SAMPLES], temp[SAMPLES];
+static uint16_t hum[SAMPLES];
+static pressure_t pressure[SAMPLES];
+static temperature_t temperature[SAMPLES];
+static humidity_t humidity[SAMPLES];
+
+/* raw temperatures spread over the whole ADC range, so that results get clamped too */
+static void fill(void) {
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        press[i] = next_random() >> 12;
+        temp[i] = (i << 8) | (next_random() >> 24);
+        hum[i] = next_random() >> 16;
+    }
+}
+
+/* compares bit for bit with bme280_compensate_data, channels not in sensor_comp must be left untouched */
+static void check(uint8_t sensor_comp, const struct bme280_calib_data *calib_data) {
+    struct bme280_batch_data comp_data = {
+        sensor_comp & BME280_PRESS ? pressure : NULL,
+        temperature,
+        sensor_comp & BME280_HUM ? humidity : NULL
+    };
+    struct bme280_calib_data scalar_calib = *calib_data;
+    memset(pressure, 0xA5, sizeof(pressure));
+    memset(humidity, 0xA5, sizeof(humidity));
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_batch(press, temp, hum, SAMPLES, &comp_data, calib_data));
+
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        struct bme280_uncomp_data uncomp = { press[i], temp[i], hum[i] };
+        struct bme280_data expected;
+        bme280_compensate_data(sensor_comp, &uncomp, &expected, &scalar_calib);
+
+        TEST_ASSERT_EQUAL_MEMORY(&expected.temperature, &temperature[i], sizeof(temperature_t));
+        if (sensor_comp & BME280_PRESS)
+            TEST_ASSERT_EQUAL_MEMORY(&expected.pressure, &pressure[i], sizeof(pressure_t));
+        else
+            TEST_ASSERT_EQUAL_HEX8(0xA5, *(const uint8_t *)&pressure[i]);
+        if (sensor_comp & BME280_HUM)
+            TEST_ASSERT_EQUAL_MEMORY(&expected.humidity, &humidity[i], sizeof(humidity_t));
+        else
+            TEST_ASSERT_EQUAL_HEX8(0xA5, *(const uint8_t *)&humidity[i]);
+    }
+}
+
+void setUp(void) {
+    random_state = RANDOM_SEED;
+    fill();
+}
+
+void tearDown(void) {
+}
+
+static void test_same_as_compensate_data(void) {
+    for (size_t i = 0; i < CALIBRATIONS; i++) {
+        struct bme280_calib_data calib_data = calibrations[i];
+        bme280_derive_calib_coeffs(&calib_data);
+
+        check(BME280_ALL, &calib_data);
+        check(BME280_TEMP | BME280_PRESS, &calib_data);
+        check(BME280_TEMP | BME280_HUM, &calib_data);
+        check(BME280_TEMP, &calib_data);
+    }
+}
+
+static void test_without_temperature_output(void) {
+    struct bme280_calib_data calib_data = calibrations[0];
+    struct bme280_batch_data comp_data = { pressure, NULL, humidity };
+    bme280_derive_calib_coeffs(&calib_data);
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_batch(press, temp, hum, SAMPLES, &comp_data, &calib_data));
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        struct bme280_uncomp_data uncomp = { press[i], temp[i], hum[i] };
+        struct bme280_data expected;
+        bme280_compensate_data(BME280_ALL, &uncomp, &expected, &calib_data);
+        TEST_ASSERT_EQUAL_MEMORY(&expected.pressure, &pressure[i], sizeof(pressure_t));
+        TEST_ASSERT_EQUAL_MEMORY(&expected.humidity, &humidity[i], sizeof(humidity_t));
+    }
+}
+
+static void test_calibration_unchanged(void) {
+    struct bme280_calib_data calib_data = calibrations[1];
+    struct bme280_batch_data comp_data = { pressure, temperature, humidity };
+    bme280_derive_calib_coeffs(&calib_data);
+    struct bme280_calib_data before = calib_data;
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_batch(press, temp, hum, SAMPLES, &comp_data, &calib_data));
+    TEST_ASSERT_EQUAL_MEMORY(&before, &calib_data, sizeof(calib_data));
+}
+
+static void test_calibration_without_coefficients(void) {
+    struct bme280_calib_data calib_data = calibrations[2];
+    struct bme280_batch_data comp_data = { pressure, temperature, humidity };
+    struct bme280_calib_data scalar_calib = calibrations[2];
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_batch(press, temp, hum, SAMPLES, &comp_data, &calib_data));
+    TEST_ASSERT_EQUAL_UINT8(0, calib_data.coeffs.valid);
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        struct bme280_uncomp_data uncomp = { press[i], temp[i], hum[i] };
+        struct bme280_data expected;
+        bme280_compensate_data(BME280_ALL, &uncomp, &expected, &scalar_calib);
+        TEST_ASSERT_EQUAL_MEMORY(&expected.temperature, &temperature[i], sizeof(temperature_t));
+        TEST_ASSERT_EQUAL_MEMORY(&expected.pressure, &pressure[i], sizeof(pressure_t));
+        TEST_ASSERT_EQUAL_MEMORY(&expected.humidity, &humidity[i], sizeof(humidity_t));
+    }
+}
+
+static void test_null_pointers(void) {
+    struct bme280_batch_data comp_data = { pressure, temperature, humidity };
+
+    TEST_ASSERT_EQUAL_INT8(BME280_E_NULL_PTR, bme280_compensate_batch(press, NULL, hum, SAMPLES, &comp_data, &calibrations[0]));
+    TEST_ASSERT_EQUAL_INT8(BME280_E_NULL_PTR, bme280_compensate_batch(press, temp, hum, SAMPLES, NULL, &calibrations[0]));
+    TEST_ASSERT_EQUAL_INT8(BME280_E_NULL_PTR, bme280_compensate_batch(press, temp, hum, SAMPLES, &comp_data, NULL));
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_batch(press, temp, hum, 0, &comp_data, &calibrations[0]));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_same_as_compensate_data);
+    RUN_TEST(test_without_temperature_output);
+    RUN_TEST(test_calibration_unchanged);
+    RUN_TEST(test_calibration_without_coefficients);
+    RUN_TEST(test_null_pointers);
+    return UNITY_END();
+}
@@ -0,0 +1,409 @@
+/*
+  Checks that the compensation from the derived coefficients gives bit for bit
+  the results of the data sheet formulas, as the driver implemented them
+  before the coefficients, for every raw temperature between -40 and 85 °C,
+  every raw pressure and humidity at a few temperatures across that range and
+  random raw values with perturbed calibrations. Build with
+  -DBME280_64BIT_ENABLE or -DBME280_FLOAT_ENABLE to check the other flavours.
+*/
+#include "bme280.h"
+#include "../bme280_fixture.h"
+
+#include <string.h>
+#include <unity.h>
+
+#ifdef BME280_FLOAT_ENABLE
+#define TEMPERATURE_SCALE 1
+#else
+#define TEMPERATURE_SCALE 100
+#endif
+
+/* the reference, compensate_* of the driver as published by Bosch */
+#ifdef BME280_FLOAT_ENABLE
+/*!
+ * @brief This internal API is used to compensate the raw temperature data and
+ * return the compensated temperature data in double data type.
+ */
+static double reference_temperature(const struct bme280_uncomp_data *uncomp_data,
+						struct bme280_calib_data *calib_data)
+{
+	double var1;
+	double var2;
+	double temperature;
+	double temperature_min = -40;
+	double temperature_max = 85;
+
+	var1 = ((double)uncomp_data->temperature) / 16384.0 - ((double)calib_data->dig_T1) / 1024.0;
+	var1 = var1 * ((double)calib_data->dig_T2);
+	var2 = (((double)uncomp_data->temperature) / 131072.0 - ((double)calib_data->dig_T1) / 8192.0);
+	var2 = (var2 * var2) * ((double)calib_data->dig_T3);
+	calib_data->t_fine = (int32_t)(var1 + var2);
+	temperature = (var1 + var2) / 5120.0;
+
+	if (temperature < temperature_min)
+		temperature = temperature_min;
+	else if (temperature > temperature_max)
+		temperature = temperature_max;
+
+	return temperature;
+}
+
+/*!
+ * @brief This internal API is used to compensate the raw pressure data and
+ * return the compensated pressure data in double data type.
+ */
+static double reference_pressure(const struct bme280_uncomp_data *uncomp_data,
+						const struct bme280_calib_data *calib_data)
+{
+	double var1;
+	double var2;
+	double var3;
+	double pressure;
+	double pressure_min = 30000.0;
+	double pressure_max = 110000.0;
+
+	var1 = ((double)calib_data->t_fine / 2.0) - 64000.0;
+	var2 = var1 * var1 * ((double)calib_data->dig_P6) / 32768.0;
+	var2 = var2 + var1 * ((double)calib_data->dig_P5) * 2.0;
+	var2 = (var2 / 4.0) + (((double)calib_data->dig_P4) * 65536.0);
+	var3 = ((double)calib_data->dig_P3) * var1 * var1 / 524288.0;
+	var1 = (var3 + ((double)calib_data->dig_P2) * var1) / 524288.0;
+	var1 = (1.0 + var1 / 32768.0) * ((double)calib_data->dig_P1);
+	/* avoid exception caused by division by zero */
+	if (var1) {
+		pressure = 1048576.0 - (double) uncomp_data->pressure;
+		pressure = (pressure - (var2 / 4096.0)) * 6250.0 / var1;
+		var1 = ((double)calib_data->dig_P9) * pressure * pressure / 2147483648.0;
+		var2 = pressure * ((double)calib_data->dig_P8) / 32768.0;
+		pressure = pressure + (var1 + var2 + ((double)calib_data->dig_P7)) / 16.0;
+
+		if (pressure < pressure_min)
+			pressure = pressure_min;
+		else if (pressure > pressure_max)
+			pressure = pressure_max;
+	} else { /* Invalid case */
+		pressure = pressure_min;
+	}
+
+	return pressure;
+}
+
+/*!
+ * @brief This internal API is used to compensate the raw humidity data and
+ * return the compensated humidity data in double data type.
+ */
+static double reference_humidity(const struct bme280_uncomp_data *uncomp_data,
+						const struct bme280_calib_data *calib_data)
+{
+	double humidity;
+	double humidity_min = 0.0;
+	double humidity_max = 100.0;
+	double var1;
+	double var2;
+	double var3;
+	double var4;
+	double var5;
+	double var6;
+
+	var1 = ((double)calib_data->t_fine) - 76800.0;
+	var2 = (((double)calib_data->dig_H4) * 64.0 + (((double)calib_data->dig_H5) / 16384.0) * var1);
+	var3 = uncomp_data->humidity - var2;
+	var4 = ((double)calib_data->dig_H2) / 65536.0;
+	var5 = (1.0 + (((double)calib_data->dig_H3) / 67108864.0) * var1);
+	var6 = 1.0 + (((double)calib_data->dig_H6) / 67108864.0) * var1 * var5;
+	var6 = var3 * var4 * (var5 * var6);
+	humidity = var6 * (1.0 - ((double)calib_data->dig_H1) * var6 / 524288.0);
+
+	if (humidity > humidity_max)
+		humidity = humidity_max;
+	else if (humidity < humidity_min)
+		humidity = humidity_min;
+
+	return humidity;
+}
+
+#else
+/*!
+ * @brief This internal API is used to compensate the raw temperature data and
+ * return the compensated temperature data in integer data type.
+ */
+static int32_t reference_temperature(const struct bme280_uncomp_data *uncomp_data,
+						struct bme280_calib_data *calib_data)
+{
+	int32_t var1;
+	int32_t var2;
+	int32_t temperature;
+	int32_t temperature_min = -4000;
+	int32_t temperature_max = 8500;
+
+	var1 = (int32_t)((uncomp_data->temperature / 8) - ((int32_t)calib_data->dig_T1 * 2));
+	var1 = (var1 * ((int32_t)calib_data->dig_T2)) / 2048;
+	var2 = (int32_t)((uncomp_data->temperature / 16) - ((int32_t)calib_data->dig_T1));
+	var2 = (((var2 * var2) / 4096) * ((int32_t)calib_data->dig_T3)) / 16384;
+	calib_data->t_fine = var1 + var2;
+	temperature = (calib_data->t_fine * 5 + 128) / 256;
+
+	if (temperature < temperature_min)
+		temperature = temperature_min;
+	else if (temperature > temperature_max)
+		temperature = temperature_max;
+
+	return temperature;
+}
+#ifdef BME280_64BIT_ENABLE
+/*!
+ * @brief This internal API is used to compensate the raw pressure data and
+ * return the compensated pressure data in integer data type with higher
+ * accuracy.
+ */
+static uint32_t reference_pressure(const struct bme280_uncomp_data *uncomp_data,
+						const struct bme280_calib_data *calib_data)
+{
+	int64_t var1;
+	int64_t var2;
+	int64_t var3;
+	int64_t var4;
+	uint32_t pressure;
+	uint32_t pressure_min = 3000000;
+	uint32_t pressure_max = 11000000;
+
+	var1 = ((int64_t)calib_data->t_fine) - 128000;
+	var2 = var1 * var1 * (int64_t)calib_data->dig_P6;
+	var2 = var2 + ((var1 * (int64_t)calib_data->dig_P5) * 131072);
+	var2 = var2 + (((int64_t)calib_data->dig_P4) * 34359738368);
+	var1 = ((var1 * var1 * (int64_t)calib_data->dig_P3) / 256) + ((var1 * ((int64_t)calib_data->dig_P2) * 4096));
+	var3 = ((int64_t)1) * 140737488355328;
+	var1 = (var3 + var1) * ((int64_t)calib_data->dig_P1) / 8589934592;
+
+	/* To avoid divide by zero exception */
+	if (var1 != 0) {
+		var4 = 1048576 - uncomp_data->pressure;
+		var4 = (((var4 * 2147483648) - var2) * 3125) / var1;
+		var1 = (((int64_t)calib_data->dig_P9) * (var4 / 8192) * (var4 / 8192)) / 33554432;
+		var2 = (((int64_t)calib_data->dig_P8) * var4) / 524288;
+		var4 = ((var4 + var1 + var2) / 256) + (((int64_t)calib_data->dig_P7) * 16);
+		pressure = (uint32_t)(((var4 / 2) * 100) / 128);
+
+		if (pressure < pressure_min)
+			pressure = pressure_min;
+		else if (pressure > pressure_max)
+			pressure = pressure_max;
+	} else {
+		pressure = pressure_min;
+	}
+
+	return pressure;
+}
+#else
+/*!
+ * @brief This internal API is used to compensate the raw pressure data and
+ * return the compensated pressure data in integer data type.
+ */
+static uint32_t reference_pressure(const struct bme280_uncomp_data *uncomp_data,
+						const struct bme280_calib_data *calib_data)
+{
+	int32_t var1;
+	int32_t var2;
+	int32_t var3;
+	int32_t var4;
+	uint32_t var5;
+	uint32_t pressure;
+	uint32_t pressure_min = 30000;
+	uint32_t pressure_max = 110000;
+
+	var1 = (((int32_t)calib_data->t_fine) / 2) - (int32_t)64000;
+	var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t)calib_data->dig_P6);
+	var2 = var2 + ((var1 * ((int32_t)calib_data->dig_P5)) * 2);
+	var2 = (var2 / 4) + (((int32_t)calib_data->dig_P4) * 65536);
+	var3 = (calib_data->dig_P3 * (((var1 / 4) * (var1 / 4)) / 8192)) / 8;
+	var4 = (((int32_t)calib_data->dig_P2) * var1) / 2;
+	var1 = (var3 + var4) / 262144;
+	var1 = (((32768 + var1)) * ((int32_t)calib_data->dig_P1)) / 32768;
+	 /* avoid exception caused by division by zero */
+	if (var1) {
+		var5 = (uint32_t)((uint32_t)1048576) - uncomp_data->pressure;
+		pressure = ((uint32_t)(var5 - (uint32_t)(var2 / 4096))) * 3125;
+		if (pressure < 0x80000000)
+			pressure = (pressure << 1) / ((uint32_t)var1);
+		else
+			pressure = (pressure / (uint32_t)var1) * 2;
+
+		var1 = (((int32_t)calib_data->dig_P9) * ((int32_t)(((pressure / 8) * (pressure / 8)) / 8192))) / 4096;
+		var2 = (((int32_t)(pressure / 4)) * ((int32_t)calib_data->dig_P8)) / 8192;
+		pressure = (uint32_t)((int32_t)pressure + ((var1 + var2 + calib_data->dig_P7) / 16));
+
+		if (pressure < pressure_min)
+			pressure = pressure_min;
+		else if (pressure > pressure_max)
+			pressure = pressure_max;
+	} else {
+		pressure = pressure_min;
+	}
+
+	return pressure;
+}
+#endif
+
+/*!
+ * @brief This internal API is used to compensate the raw humidity data and
+ * return the compensated humidity data in integer data type.
+ */
+static uint32_t reference_humidity(const struct bme280_uncomp_data *uncomp_data,
+						const struct bme280_calib_data *calib_data)
+{
+	int32_t var1;
+	int32_t var2;
+	int32_t var3;
+	int32_t var4;
+	int32_t var5;
+	uint32_t humidity;
+	uint32_t humidity_max = 102400;
+
+	var1 = calib_data->t_fine - ((int32_t)76800);
+	var2 = (int32_t)(uncomp_data->humidity * 16384);
+	var3 = (int32_t)(((int32_t)calib_data->dig_H4) * 1048576);
+	var4 = ((int32_t)calib_data->dig_H5) * var1;
+	var5 = (((var2 - var3) - var4) + (int32_t)16384) / 32768;
+	var2 = (var1 * ((int32_t)calib_data->dig_H6)) / 1024;
+	var3 = (var1 * ((int32_t)calib_data->dig_H3)) / 2048;
+	var4 = ((var2 * (var3 + (int32_t)32768)) / 1024) + (int32_t)2097152;
+	var2 = ((var4 * ((int32_t)calib_data->dig_H2)) + 8192) / 16384;
+	var3 = var5 * var2;
+	var4 = ((var3 / 32768) * (var3 / 32768)) / 128;
+	var5 = var3 - ((var4 * ((int32_t)calib_data->dig_H1)) / 16);
+	var5 = (var5 < 0 ? 0 : var5);
+	var5 = (var5 > 419430400 ? 419430400 : var5);
+	humidity = (uint32_t)(var5 / 4096);
+
+	if (humidity > humidity_max)
+		humidity = humidity_max;
+
+	return humidity;
+}
+#endif
+
+/* compares bit for bit, so that double results that differ in the last place count too */
+static int same(struct bme280_calib_data *calib_data, uint32_t press, uint32_t temp, uint32_t hum) {
+    struct bme280_uncomp_data uncomp = { press, temp, hum };
+    struct bme280_calib_data reference_calib = *calib_data;
+    struct bme280_data expected, actual;
+    memset(&expected, 0, sizeof(expected));
+    memset(&actual, 0, sizeof(actual));
+
+    expected.temperature = reference_temperature(&uncomp, &reference_calib);
+    expected.pressure = reference_pressure(&uncomp, &reference_calib);
+    expected.humidity = reference_humidity(&uncomp, &reference_calib);
+    bme280_compensate_data(BME280_ALL, &uncomp, &actual, calib_data);
+
+    return !memcmp(&expected, &actual, sizeof(expected)) && reference_calib.t_fine == calib_data->t_fine;
+}
+
+/* raw temperatures from the lowest one that compensates above -40 °C to the highest one below 85 °C */
+static void temperature_range(struct bme280_calib_data *calib_data, uint32_t *low, uint32_t *high) {
+    *low = 0;
+    *high = 0;
+    for (uint32_t raw = 0; raw < (1 << 20); raw++) {
+        struct bme280_uncomp_data uncomp = { 0, raw, 0 };
+        double temperature = reference_temperature(&uncomp, calib_data);
+        if (temperature > -40 * TEMPERATURE_SCALE && temperature < 85 * TEMPERATURE_SCALE) {
+            if (!*low) *low = raw;
+            *high = raw;
+        }
+    }
+}
+
+/* trim values with their low bits flipped, still shaped like the ones of a real chip */
+static void perturb(struct bme280_calib_data *calib_data) {
+    calib_data->dig_T1 ^= next_random() & 0x3ff;
+    calib_data->dig_T2 ^= next_random() & 0x3ff;
+    calib_data->dig_T3 ^= next_random() & 0x3f;
+    calib_data->dig_P1 ^= next_random() & 0x3ff;
+    calib_data->dig_P2 ^= next_random() & 0x3ff;
+    calib_data->dig_P3 ^= next_random() & 0x3ff;
+    calib_data->dig_P4 ^= next_random() & 0x3ff;
+    calib_data->dig_P5 ^= next_random() & 0x3f;
+    calib_data->dig_P6 ^= next_random() & 0x7;
+    calib_data->dig_P7 ^= next_random() & 0x3ff;
+    calib_data->dig_P8 ^= next_random() & 0x3ff;
+    calib_data->dig_P9 ^= next_random() & 0x3ff;
+    calib_data->dig_H1 ^= next_random() & 0x3f;
+    calib_data->dig_H2 ^= next_random() & 0x3f;
+    calib_data->dig_H3 ^= next_random() & 0x3f;
+    calib_data->dig_H4 ^= next_random() & 0x3f;
+    calib_data->dig_H5 ^= next_random() & 0x3f;
+    calib_data->dig_H6 ^= next_random() & 0x7;
+}
+
+void setUp(void) {
+    random_state = RANDOM_SEED;
+}
+
+void tearDown(void) {
+}
+
+static void test_every_raw_temperature(void) {
+    for (size_t i = 0; i < CALIBRATIONS; i++) {
+        struct bme280_calib_data calib_data = calibrations[i];
+        uint32_t low, high;
+        temperature_range(&calib_data, &low, &high);
+        TEST_ASSERT_TRUE(low < high);
+
+        for (uint32_t temp = low; temp <= high; temp++) {
+            uint32_t press = next_random() >> 12;
+            uint32_t hum = next_random() >> 16;
+            if (!same(&calib_data, press, temp, hum)) TEST_FAIL_MESSAGE("raw temperature differs");
+        }
+    }
+}
+
+static void test_every_raw_pressure_and_humidity(void) {
+    for (size_t i = 0; i < CALIBRATIONS; i++) {
+        struct bme280_calib_data calib_data = calibrations[i];
+        uint32_t low, high;
+        temperature_range(&calib_data, &low, &high);
+
+        for (uint32_t step = 0; step < 8; step++) {
+            uint32_t temp = low + (uint32_t)((uint64_t)(high - low) * step / 7);
+            for (uint32_t press = 0; press < (1 << 20); press++) {
+                if (!same(&calib_data, press, temp, next_random() >> 16)) TEST_FAIL_MESSAGE("raw pressure differs");
+            }
+            for (uint32_t hum = 0; hum < (1 << 16); hum++) {
+                if (!same(&calib_data, next_random() >> 12, temp, hum)) TEST_FAIL_MESSAGE("raw humidity differs");
+            }
+        }
+    }
+}
+
+static void test_perturbed_calibrations(void) {
+    for (size_t i = 0; i < 1000; i++) {
+        struct bme280_calib_data calib_data = calibrations[i % CALIBRATIONS];
+        perturb(&calib_data);
+
+        for (size_t j = 0; j < 1000; j++) {
+            if (!same(&calib_data, next_random() >> 12, next_random() >> 12, next_random() >> 16))
+                TEST_FAIL_MESSAGE("random raw values differ");
+        }
+    }
+}
+
+static void test_derived_on_first_use(void) {
+    struct bme280_calib_data calib_data = calibrations[0];
+    struct bme280_calib_data derived = calibrations[0];
+    struct bme280_uncomp_data uncomp = { 415148, 519888, 28000 };
+    struct bme280_data data;
+
+    TEST_ASSERT_EQUAL_UINT8(0, calib_data.coeffs.valid);
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_compensate_data(BME280_ALL, &uncomp, &data, &calib_data));
+    bme280_derive_calib_coeffs(&derived);
+    TEST_ASSERT_EQUAL_UINT8(1, calib_data.coeffs.valid);
+    TEST_ASSERT_EQUAL_MEMORY(&derived.coeffs, &calib_data.coeffs, sizeof(derived.coeffs));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_raw_temperature);
+    RUN_TEST(test_every_raw_pressure_and_humidity);
+    RUN_TEST(test_perturbed_calibrations);
+    RUN_TEST(test_derived_on_first_use);
+    return UNITY_END();
+}
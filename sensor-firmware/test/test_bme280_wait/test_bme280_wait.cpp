@@ -0,0 +1,92 @@
+#include "bme280_sim.h"
+
+#include <unity.h>
+
+static struct bme280_dev device;
+static uint32_t waited_us;
+static uint32_t typ_us, max_us;
+
+static void wait(uint32_t microseconds) {
+    BME280Sim::advance(microseconds);
+    waited_us += microseconds;
+}
+
+static uint32_t time_us() {
+    return BME280Sim::now();
+}
+
+// an initialized sensor with all channels, and the microsecond wait and clock Sensor::init sets
+void setUp() {
+    BME280Sim::reset();
+    device = bme280_dev();
+    BME280Sim::attach(&device);
+    device.delay_us = wait;
+    device.time_us = time_us;
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_init(&device));
+    device.settings.osr_h = BME280_OVERSAMPLING_1X;
+    device.settings.osr_p = BME280_OVERSAMPLING_1X;
+    device.settings.osr_t = BME280_OVERSAMPLING_1X;
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_set_sensor_settings(BME280_OSR_PRESS_SEL | BME280_OSR_TEMP_SEL | BME280_OSR_HUM_SEL, &device));
+    bme280_calc_measurement_time(&device.settings, &typ_us, &max_us);
+    waited_us = 0;
+}
+
+void tearDown() {
+}
+
+static void test_waits_typical_time() {
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_trigger_measurement(&device));
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_wait_for_measurement(&device));
+
+    TEST_ASSERT_EQUAL_UINT32(typ_us, waited_us);
+    struct bme280_data data;
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_fetch_measurement(BME280_ALL, &data, &device));
+}
+
+// work done between the trigger and the wait shortens the wait
+static void test_counts_from_trigger() {
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_trigger_measurement(&device));
+    BME280Sim::advance(5000);
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_wait_for_measurement(&device));
+    TEST_ASSERT_EQUAL_UINT32(typ_us - 5000, waited_us);
+
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_trigger_measurement(&device));
+    BME280Sim::advance(typ_us);
+    waited_us = 0;
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_wait_for_measurement(&device));
+    TEST_ASSERT_EQUAL_UINT32(0, waited_us);
+}
+
+static void test_counts_from_call_without_clock() {
+    device.time_us = NULL;
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_trigger_measurement(&device));
+    BME280Sim::advance(5000);
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_wait_for_measurement(&device));
+
+    TEST_ASSERT_EQUAL_UINT32(typ_us, waited_us);
+}
+
+// delay_ms rounds the typical time up to whole milliseconds
+static void test_millisecond_delay_without_delay_us() {
+    device.delay_us = NULL;
+    BME280Sim::resetStats();
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_trigger_measurement(&device));
+    TEST_ASSERT_EQUAL_INT8(BME280_OK, bme280_wait_for_measurement(&device));
+
+    TEST_ASSERT_EQUAL_UINT64((typ_us + 999) / 1000 * 1000, BME280Sim::getStats().delay_time_us);
+}
+
+static void test_nothing_to_wait_for() {
+    TEST_ASSERT_EQUAL_INT8(BME280_E_NO_MEASUREMENT, bme280_wait_for_measurement(&device));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_waits_typical_time);
+    RUN_TEST(test_counts_from_trigger);
+    RUN_TEST(test_counts_from_call_without_clock);
+    RUN_TEST(test_millisecond_delay_without_delay_us);
+    RUN_TEST(test_nothing_to_wait_for);
+    return UNITY_END();
+}
@@ -0,0 +1,114 @@
+#include "hci.h"
+
+#include <string.h>
+#include <unity.h>
+
+// fill byte, shows what a command did not write
+#define UNWRITTEN 0xAA
+
+static uint8_t packet[HCI::MAX_COMMAND_LEN + 1];
+
+void setUp() {
+    memset(packet, UNWRITTEN, sizeof(packet));
+}
+
+void tearDown() {
+}
+
+static void test_le_set_adv_params() {
+    HCI::AdvParams params = {
+        0x02E6, 0x0320, HCI::ADV_NONCONN_IND, HCI::ADDR_RANDOM, HCI::CHANNEL_ALL, HCI::FILTER_NONE
+    };
+    const uint8_t expected[] = {
+        0x01,             // command packet
+        0x06, 0x20,       // opcode 0x2006, little endian
+        15,               // parameter length
+        0xE6, 0x02,       // interval min
+        0x20, 0x03,       // interval max
+        0x03,             // non-connectable undirected
+        0x01,             // own address type
+        0x00,             // peer address type
+        0, 0, 0, 0, 0, 0, // peer address
+        0x07,             // all channels
+        0x00              // no filter
+    };
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), HCI::leSetAdvParams(packet, params));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, packet, sizeof(expected));
+    TEST_ASSERT_EQUAL_HEX8(UNWRITTEN, packet[sizeof(expected)]);
+}
+
+static void test_le_set_adv_data() {
+    const uint8_t data[] = { 0x05, 0xFF, 0xFF, 0xFF, 0x81, 0x00 };
+    uint8_t expected[4 + 1 + HCI::ADV_DATA_MAX_LEN] = {
+        0x01, 0x08, 0x20, // command packet, opcode 0x2008
+        32,               // parameter length
+        sizeof(data)      // significant part of the data
+    };
+    memcpy(expected + 5, data, sizeof(data)); // the rest of the 31 bytes stays zero
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), HCI::leSetAdvData(packet, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, packet, sizeof(expected));
+    TEST_ASSERT_EQUAL_HEX8(UNWRITTEN, packet[sizeof(expected)]);
+}
+
+static void test_le_set_adv_data_truncates() {
+    uint8_t data[HCI::ADV_DATA_MAX_LEN + 1];
+    for (uint8_t i = 0; i < sizeof(data); i++) data[i] = i + 1;
+
+    TEST_ASSERT_EQUAL_UINT16(4 + 1 + HCI::ADV_DATA_MAX_LEN, HCI::leSetAdvData(packet, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_UINT8(HCI::ADV_DATA_MAX_LEN, packet[4]);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(data, packet + 5, HCI::ADV_DATA_MAX_LEN);
+    TEST_ASSERT_EQUAL_HEX8(UNWRITTEN, packet[4 + 1 + HCI::ADV_DATA_MAX_LEN]);
+}
+
+static void test_le_set_scan_response_data() {
+    const uint8_t data[] = { 0x03, 0x09, 'N', 'N' };
+    uint8_t expected[4 + 1 + HCI::ADV_DATA_MAX_LEN] = {
+        0x01, 0x09, 0x20, // command packet, opcode 0x2009
+        32,
+        sizeof(data)
+    };
+    memcpy(expected + 5, data, sizeof(data));
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), HCI::leSetScanResponseData(packet, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, packet, sizeof(expected));
+}
+
+static void test_le_set_adv_enable() {
+    const uint8_t enable[] = { 0x01, 0x0A, 0x20, 1, 0x01 };
+    const uint8_t disable[] = { 0x01, 0x0A, 0x20, 1, 0x00 };
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(enable), HCI::leSetAdvEnable(packet, true));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(enable, packet, sizeof(enable));
+    TEST_ASSERT_EQUAL_HEX8(UNWRITTEN, packet[sizeof(enable)]);
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(disable), HCI::leSetAdvEnable(packet, false));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(disable, packet, sizeof(disable));
+}
+
+static void test_parse_command_complete() {
+    // event packet, Command Complete, parameter length, allowed commands, opcode 0x200A, status
+    const uint8_t complete[] = { 0x04, 0x0E, 4, 1, 0x0A, 0x20, 0x0C };
+    const uint8_t other_event[] = { 0x04, 0x0F, 4, 0x00, 1, 0x0A, 0x20 };
+    uint16_t opcode = 0;
+    uint8_t status = 0;
+
+    TEST_ASSERT_TRUE(HCI::parseCommandComplete(complete, sizeof(complete), &opcode, &status));
+    TEST_ASSERT_EQUAL_HEX16(HCI::LE_SET_ADV_ENABLE, opcode);
+    TEST_ASSERT_EQUAL_HEX8(0x0C, status);
+
+    TEST_ASSERT_FALSE(HCI::parseCommandComplete(other_event, sizeof(other_event), &opcode, &status));
+    TEST_ASSERT_FALSE(HCI::parseCommandComplete(complete, sizeof(complete) - 1, &opcode, &status));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_le_set_adv_params);
+    RUN_TEST(test_le_set_adv_data);
+    RUN_TEST(test_le_set_adv_data_truncates);
+    RUN_TEST(test_le_set_scan_response_data);
+    RUN_TEST(test_le_set_adv_enable);
+    RUN_TEST(test_parse_command_complete);
+    return UNITY_END();
+}
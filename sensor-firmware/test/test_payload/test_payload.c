@@ -0,0 +1,171 @@
+#include "payload.h"
+
+#include <string.h>
+#include <unity.h>
+
+/* every field flag, in bit order */
+static const uint8_t fields[PAYLOAD_FIELD_COUNT] = {
+    PAYLOAD_TEMPERATURE, PAYLOAD_HUMIDITY, PAYLOAD_PRESSURE, PAYLOAD_SEQUENCE,
+    PAYLOAD_BATTERY, PAYLOAD_STATUS, PAYLOAD_PERIOD
+};
+
+/* all field flags that are set in the bits of combination, one bit per field */
+static uint8_t combination_flags(uint8_t combination) {
+    uint8_t flags = 0;
+    for (uint8_t i = 0; i < PAYLOAD_FIELD_COUNT; i++) {
+        if (combination & (1 << i)) flags |= fields[i];
+    }
+
+    return flags;
+}
+
+/* values that use both bytes of the wide fields and the sign of the temperature */
+static struct sensor_payload reading(uint8_t flags, uint16_t i) {
+    struct sensor_payload payload = { 0 };
+    payload.version = PAYLOAD_VERSION;
+    payload.flags = flags;
+    payload.temperature = -1234 + 7 * i;
+    payload.humidity = 4567 - 3 * i;
+    payload.pressure = 10132 + i;
+    payload.sequence = 65534 + i;
+    payload.battery = 3012 - i;
+    payload.status = PAYLOAD_STATUS_COLD_BOOT;
+    payload.period = 600;
+    return payload;
+}
+
+static void assert_fields(const struct sensor_payload *expected, const struct sensor_payload *actual) {
+    uint8_t flags = expected->flags;
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_VERSION, actual->version);
+    TEST_ASSERT_EQUAL_HEX8(flags, actual->flags);
+    /* fields not present decode as 0 */
+    TEST_ASSERT_EQUAL_INT16(flags & PAYLOAD_TEMPERATURE ? expected->temperature : 0, actual->temperature);
+    TEST_ASSERT_EQUAL_UINT16(flags & PAYLOAD_HUMIDITY ? expected->humidity : 0, actual->humidity);
+    TEST_ASSERT_EQUAL_UINT16(flags & PAYLOAD_PRESSURE ? expected->pressure : 0, actual->pressure);
+    TEST_ASSERT_EQUAL_UINT16(flags & PAYLOAD_SEQUENCE ? expected->sequence : 0, actual->sequence);
+    TEST_ASSERT_EQUAL_UINT16(flags & PAYLOAD_BATTERY ? expected->battery : 0, actual->battery);
+    TEST_ASSERT_EQUAL_UINT8(flags & PAYLOAD_STATUS ? expected->status : 0, actual->status);
+    TEST_ASSERT_EQUAL_UINT16(flags & PAYLOAD_PERIOD ? expected->period : 0, actual->period);
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void test_encode_all_fields(void) {
+    struct sensor_payload payload = reading(0xFF & ~PAYLOAD_BATCH, 0);
+    const uint8_t expected[] = {
+        0x81, 0xBF,
+        0x2E, 0xFB, /* -1234 */
+        0xD7, 0x11, /* 4567 */
+        0x94, 0x27, /* 10132 */
+        0xFE, 0xFF, /* 65534 */
+        0xC4, 0x0B, /* 3012 */
+        0x01,       /* cold boot */
+        0x58, 0x02  /* 600 */
+    };
+    uint8_t buffer[PAYLOAD_MAX_SIZE];
+
+    TEST_ASSERT_EQUAL_UINT8(sizeof(expected), payload_encode(&payload, buffer));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+    TEST_ASSERT_EQUAL_UINT8(PAYLOAD_MAX_SIZE, sizeof(expected));
+}
+
+static void test_round_trip_every_flag_combination(void) {
+    for (uint16_t combination = 0; combination < (1 << PAYLOAD_FIELD_COUNT); combination++) {
+        struct sensor_payload payload = reading(combination_flags(combination), 0), decoded;
+        uint8_t buffer[PAYLOAD_MAX_SIZE + 1];
+        memset(buffer, 0xAA, sizeof(buffer));
+
+        uint8_t len = payload_encode(&payload, buffer);
+        TEST_ASSERT_EQUAL_UINT8(payload_size(payload.flags), len);
+        TEST_ASSERT_EQUAL_HEX8(0xAA, buffer[len]);
+        TEST_ASSERT_EQUAL_HEX8(PAYLOAD_VERSION_MARKER | PAYLOAD_VERSION, buffer[0]);
+        TEST_ASSERT_EQUAL_HEX8(payload.flags, buffer[1]);
+
+        memset(&decoded, 0x55, sizeof(decoded));
+        TEST_ASSERT_EQUAL_INT8(0, payload_decode(buffer, len, &decoded));
+        assert_fields(&payload, &decoded);
+
+        /* one byte short */
+        TEST_ASSERT_EQUAL_INT8(-1, payload_decode(buffer, len - 1, &decoded));
+    }
+}
+
+static void test_batch_round_trip_every_flag_combination(void) {
+    const uint8_t count = 4;
+    for (uint16_t combination = 0; combination < (1 << PAYLOAD_FIELD_COUNT); combination++) {
+        uint8_t flags = combination_flags(combination);
+        struct sensor_payload records[4], decoded[4];
+        for (uint8_t i = 0; i < count; i++) records[i] = reading(flags, i);
+        uint8_t buffer[PAYLOAD_MAX_FRAME_SIZE];
+
+        uint16_t size = payload_batch_size(records, count, flags);
+        uint8_t len = payload_encode_batch(records, count, flags, buffer);
+        if (size > PAYLOAD_MAX_FRAME_SIZE) {
+            TEST_ASSERT_EQUAL_UINT8(0, len);
+            continue;
+        }
+        TEST_ASSERT_EQUAL_UINT8(size, len);
+        TEST_ASSERT_EQUAL_HEX8(PAYLOAD_VERSION_MARKER | PAYLOAD_VERSION, buffer[0]);
+        TEST_ASSERT_EQUAL_HEX8(flags | PAYLOAD_BATCH, buffer[1]);
+        TEST_ASSERT_EQUAL_UINT8(count, buffer[2]);
+
+        TEST_ASSERT_EQUAL_INT8(count, payload_decode_batch(buffer, len, decoded, count));
+        for (uint8_t i = 0; i < count; i++) assert_fields(&records[i], &decoded[i]);
+
+        /* a batch is not a single reading, and does not fit fewer records */
+        TEST_ASSERT_EQUAL_INT8(-1, payload_decode(buffer, len, decoded));
+        TEST_ASSERT_EQUAL_INT8(-1, payload_decode_batch(buffer, len, decoded, count - 1));
+    }
+}
+
+static void test_decode_legacy(void) {
+    const uint8_t data[] = { 0x03, 0x2E, 0xFB, 0xD7, 0x11 };
+    struct sensor_payload payload;
+
+    TEST_ASSERT_EQUAL_INT8(0, payload_decode(data, sizeof(data), &payload));
+    TEST_ASSERT_EQUAL_UINT8(0, payload.version);
+    TEST_ASSERT_EQUAL_HEX8(PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY, payload.flags);
+    TEST_ASSERT_EQUAL_INT16(-1234, payload.temperature);
+    TEST_ASSERT_EQUAL_UINT16(4567, payload.humidity);
+    TEST_ASSERT_EQUAL_UINT16(0, payload.sequence);
+}
+
+static void test_decode_rejects_malformed(void) {
+    const uint8_t newer_version[] = { 0x82, PAYLOAD_TEMPERATURE, 0x00, 0x00 };
+    const uint8_t batch[] = { 0x81, PAYLOAD_BATCH | PAYLOAD_TEMPERATURE, 1, 0x00 };
+    struct sensor_payload payload;
+
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode(newer_version, sizeof(newer_version), &payload));
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode(newer_version, 0, &payload));
+    /* version without flags, batch without count */
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode_batch(batch, 1, &payload, 1));
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode_batch(batch, 2, &payload, 1));
+}
+
+static void test_decode_rejects_unknown_flags(void) {
+    /* legacy payloads with a flag their firmware never sent, e.g. pressure or bit 6 */
+    const uint8_t legacy_pressure[] = { 0x07, 0x2E, 0xFB, 0xD7, 0x11, 0x00, 0x00 };
+    const uint8_t legacy_bit_6[] = { 0x43, 0x2E, 0xFB, 0xD7, 0x11 };
+    struct sensor_payload payload;
+
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode(legacy_pressure, sizeof(legacy_pressure), &payload));
+    TEST_ASSERT_EQUAL_INT8(-1, payload_decode(legacy_bit_6, sizeof(legacy_bit_6), &payload));
+    /* version 1 assigns every bit, its next field needs a new version */
+    TEST_ASSERT_EQUAL_HEX8(0xFF, PAYLOAD_TEMPERATURE | PAYLOAD_HUMIDITY | PAYLOAD_PRESSURE | PAYLOAD_SEQUENCE |
+                                 PAYLOAD_BATTERY | PAYLOAD_STATUS | PAYLOAD_PERIOD | PAYLOAD_BATCH);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_encode_all_fields);
+    RUN_TEST(test_round_trip_every_flag_combination);
+    RUN_TEST(test_batch_round_trip_every_flag_combination);
+    RUN_TEST(test_decode_legacy);
+    RUN_TEST(test_decode_rejects_malformed);
+    RUN_TEST(test_decode_rejects_unknown_flags);
+    return UNITY_END();
+}
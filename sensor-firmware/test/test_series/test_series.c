@@ -0,0 +1,152 @@
+#include "series.h"
+#include "../xorshift.h"
+
+#include <string.h>
+#include <unity.h>
+
+#define MAX_COUNT 255
+#define ROUNDS 2000
+
+static int32_t step(int32_t max) {
+    return (int32_t)(next_random() % (2 * max + 1)) - max;
+}
+
+/* encodes and decodes the values, checking the size and that all bytes are consumed */
+static void assert_round_trip(const int32_t *values, uint8_t count) {
+    uint8_t buffer[MAX_COUNT * SERIES_MAX_VARINT_SIZE];
+    int32_t decoded[MAX_COUNT];
+
+    uint16_t size = series_size(values, count);
+    uint16_t len = series_encode(values, count, buffer, sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT16(size, len);
+    TEST_ASSERT_EQUAL_INT16(len, series_decode(buffer, len, decoded, count));
+    if (count) TEST_ASSERT_EQUAL_INT32_ARRAY(values, decoded, count);
+}
+
+void setUp(void) {
+    random_state = RANDOM_SEED;
+}
+
+void tearDown(void) {
+}
+
+static void test_zigzag_edges(void) {
+    const int32_t values[] = { 0, -1, 1, -2, 2, INT16_MIN, INT16_MAX, INT32_MIN + 1, INT32_MIN, INT32_MAX };
+    const uint32_t zigzag[] = { 0, 1, 2, 3, 4, 0xFFFF, 0xFFFE, 0xFFFFFFFD, 0xFFFFFFFF, 0xFFFFFFFE };
+
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        TEST_ASSERT_EQUAL_HEX32(zigzag[i], series_zigzag(values[i]));
+        TEST_ASSERT_EQUAL_INT32(values[i], series_unzigzag(zigzag[i]));
+    }
+}
+
+static void test_varint_size_edges(void) {
+    const uint32_t values[] = { 0, 0x7F, 0x80, 0x3FFF, 0x4000, 0x1FFFFF, 0x200000, 0xFFFFFFF, 0x10000000, 0xFFFFFFFF };
+    const uint8_t sizes[] = { 1, 1, 2, 2, 3, 3, 4, 4, 5, 5 };
+
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+        TEST_ASSERT_EQUAL_UINT8(sizes[i], series_varint_size(values[i]));
+}
+
+static void test_encode_exact(void) {
+    /* 21.00 °C, then +0.05, -0.01 and no change */
+    const int32_t values[] = { 2100, 2105, 2104, 2104 };
+    const uint8_t expected[] = { 0xE8, 0x20, 0x0A, 0x01, 0x00 };
+    uint8_t buffer[sizeof(values) / sizeof(values[0]) * SERIES_MAX_VARINT_SIZE];
+
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), series_encode(values, 4, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+/* the largest deltas of 16 bit fields, as in the payload */
+static void test_int16_extremes(void) {
+    const int32_t values[] = { INT16_MIN, INT16_MAX, INT16_MIN, INT16_MIN, INT16_MAX, 0, UINT16_MAX, 0 };
+    /* zigzag(-32768) = 65535, zigzag(+65535) = 131070 */
+    const uint8_t expected[] = { 0xFF, 0xFF, 0x03, 0xFE, 0xFF, 0x07 };
+    uint8_t buffer[sizeof(expected)];
+
+    assert_round_trip(values, sizeof(values) / sizeof(values[0]));
+    TEST_ASSERT_EQUAL_UINT16(sizeof(expected), series_encode(values, 2, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buffer, sizeof(expected));
+}
+
+/* deltas wrap around at 32 bits, so the largest steps still round trip */
+static void test_int32_extremes(void) {
+    const int32_t values[] = { INT32_MIN, INT32_MAX, INT32_MIN, 0, INT32_MAX, -1, INT32_MIN + 1 };
+
+    assert_round_trip(values, sizeof(values) / sizeof(values[0]));
+    /* INT32_MIN is 5 bytes, INT32_MAX - INT32_MIN wraps to -1, 1 byte */
+    TEST_ASSERT_EQUAL_UINT16(6, series_size(values, 2));
+}
+
+static void test_truncated_rejected(void) {
+    const int32_t values[] = { 2100, 70000, -5, 123456789 };
+    uint8_t buffer[sizeof(values) / sizeof(values[0]) * SERIES_MAX_VARINT_SIZE];
+    int32_t decoded[4];
+
+    uint16_t len = series_encode(values, 4, buffer, sizeof(buffer));
+    for (uint16_t shorter = 0; shorter < len; shorter++)
+        TEST_ASSERT_EQUAL_INT16(-1, series_decode(buffer, shorter, decoded, 4));
+    /* a continuation bit on the last byte */
+    buffer[len - 1] |= 0x80;
+    TEST_ASSERT_EQUAL_INT16(-1, series_decode(buffer, len, decoded, 4));
+}
+
+static void test_overlong_rejected(void) {
+    const uint8_t largest[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x0F };
+    const uint8_t six_bytes[] = { 0x80, 0x80, 0x80, 0x80, 0x80, 0x00 };
+    const uint8_t above_32_bits[] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x1F };
+    const uint8_t bit_38[] = { 0x80, 0x80, 0x80, 0x80, 0x40 };
+    int32_t value;
+
+    TEST_ASSERT_EQUAL_INT16(5, series_decode(largest, sizeof(largest), &value, 1));
+    TEST_ASSERT_EQUAL_INT32(INT32_MIN, value);
+    TEST_ASSERT_EQUAL_INT16(-1, series_decode(six_bytes, sizeof(six_bytes), &value, 1));
+    TEST_ASSERT_EQUAL_INT16(-1, series_decode(above_32_bits, sizeof(above_32_bits), &value, 1));
+    TEST_ASSERT_EQUAL_INT16(-1, series_decode(bit_38, sizeof(bit_38), &value, 1));
+}
+
+static void test_encode_respects_max_len(void) {
+    const int32_t values[] = { 2100, 70000, -5 };
+    uint8_t buffer[16];
+    memset(buffer, 0xAA, sizeof(buffer));
+
+    uint16_t len = series_size(values, 3);
+    TEST_ASSERT_EQUAL_UINT16(0, series_encode(values, 3, buffer, len - 1));
+    TEST_ASSERT_EQUAL_UINT16(len, series_encode(values, 3, buffer, len));
+    TEST_ASSERT_EQUAL_HEX8(0xAA, buffer[len]);
+}
+
+static void test_random_round_trips(void) {
+    int32_t values[MAX_COUNT];
+
+    for (int round = 0; round < ROUNDS; round++) {
+        uint8_t count = next_random() % (MAX_COUNT + 1);
+        int32_t value = (int32_t)next_random();
+        for (uint8_t i = 0; i < count; i++) {
+            switch (round % 4) {
+            case 0: value += step(3); break;          /* slowly changing readings */
+            case 1: value += step(100000); break;
+            case 2: value = (int32_t)next_random(); break;
+            default: value = next_random() & 1 ? INT32_MIN : INT32_MAX; break;
+            }
+            values[i] = value;
+        }
+
+        assert_round_trip(values, count);
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_zigzag_edges);
+    RUN_TEST(test_varint_size_edges);
+    RUN_TEST(test_encode_exact);
+    RUN_TEST(test_int16_extremes);
+    RUN_TEST(test_int32_extremes);
+    RUN_TEST(test_truncated_rejected);
+    RUN_TEST(test_overlong_rejected);
+    RUN_TEST(test_encode_respects_max_len);
+    RUN_TEST(test_random_round_trips);
+    return UNITY_END();
+}
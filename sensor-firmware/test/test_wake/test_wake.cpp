@@ -0,0 +1,109 @@
+#include "wake.h"
+
+#include "bme280_sim.h"
+#include "esp_sleep.h"
+#include "../../src/native/fake.h"
+
+#include <unity.h>
+
+#define PHASE_MILLISECONDS 7000
+#define AWAKE_MICROSECONDS 50000
+
+// goes through deep sleep until the next wake and returns its target
+static uint64_t sleepAndWake(uint32_t period_seconds, uint64_t awake_us = AWAKE_MICROSECONDS) {
+    BME280Sim::advance(awake_us);
+    uint64_t duration = Wake::sleepDuration(period_seconds * 1000, PHASE_MILLISECONDS);
+    esp_deep_sleep(duration);
+    BME280Sim::advance(duration);
+    Fake::reboot();
+
+    uint64_t woke_at = BME280Sim::now();
+    Wake::begin();
+    return woke_at - Wake::getStats().last_error_us;
+}
+
+// a power-on reset, which starts a new schedule
+void setUp() {
+    BME280Sim::reset();
+    esp_deep_sleep(0);
+    Fake::reboot();
+    Wake::begin();
+}
+
+void tearDown() {
+}
+
+static void test_first_wake_on_phase() {
+    uint64_t target = sleepAndWake(60);
+
+    TEST_ASSERT_EQUAL_UINT64(PHASE_MILLISECONDS * 1000ULL, target % 60000000);
+    TEST_ASSERT_EQUAL_UINT32(1, Wake::getStats().wakes);
+}
+
+static void test_fixed_period() {
+    uint64_t last = sleepAndWake(60);
+
+    for (int i = 0; i < 20; i++) {
+        uint64_t target = sleepAndWake(60);
+        TEST_ASSERT_EQUAL_UINT64(60000000, target - last);
+        last = target;
+    }
+}
+
+// a SCHEDULE_RATE run: each wake reports the period until the next one, which must be the interval slept
+static void test_period_changes() {
+    const uint32_t periods[] = { 60, 120, 240, 30, 30, 900, 60, 45, 600, 60 };
+    uint64_t last = sleepAndWake(periods[0]);
+
+    for (size_t i = 1; i < sizeof(periods) / sizeof(periods[0]); i++) {
+        uint64_t target = sleepAndWake(periods[i]);
+        TEST_ASSERT_EQUAL_UINT64(periods[i] * 1000000ULL, target - last);
+        last = target;
+    }
+}
+
+// a wake that took longer than the period skips to a later multiple of it, the next one is on time again
+static void test_missed_target() {
+    uint64_t last = sleepAndWake(2);
+    uint64_t target = sleepAndWake(2, 2500000);
+
+    TEST_ASSERT_EQUAL_UINT64(4000000, target - last);
+    last = target;
+    target = sleepAndWake(2);
+    TEST_ASSERT_EQUAL_UINT64(2000000, target - last);
+}
+
+static void test_reset_starts_new_schedule() {
+    sleepAndWake(60);
+    sleepAndWake(45);
+
+    BME280Sim::advance(AWAKE_MICROSECONDS);
+    Fake::reboot();
+    Wake::begin();
+    TEST_ASSERT_EQUAL_UINT32(0, Wake::getStats().wakes);
+
+    uint64_t target = sleepAndWake(60);
+    TEST_ASSERT_EQUAL_UINT64(PHASE_MILLISECONDS * 1000ULL, target % 60000000);
+}
+
+static void test_error_statistics() {
+    for (int i = 0; i < 50; i++) sleepAndWake(60);
+
+    Wake::Stats stats = Wake::getStats();
+    TEST_ASSERT_EQUAL_UINT32(50, stats.wakes);
+    TEST_ASSERT_TRUE(Wake::meanError(stats) >= stats.min_error_us);
+    TEST_ASSERT_TRUE(Wake::meanError(stats) <= stats.max_error_us);
+    TEST_ASSERT_TRUE(Wake::errorDeviation(stats) > 0);
+    TEST_ASSERT_TRUE(Wake::errorDeviation(stats) <= stats.max_error_us - stats.min_error_us);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_wake_on_phase);
+    RUN_TEST(test_fixed_period);
+    RUN_TEST(test_period_changes);
+    RUN_TEST(test_missed_target);
+    RUN_TEST(test_reset_starts_new_schedule);
+    RUN_TEST(test_error_statistics);
+    return UNITY_END();
+}
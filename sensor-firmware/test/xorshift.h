@@ -0,0 +1,19 @@
+#ifndef XORSHIFT_H_
+#define XORSHIFT_H_
+
+/* Random values for the test suites and benchmarks. Header only, each program gets its own state. */
+#include <stdint.h>
+
+#define RANDOM_SEED 2463534242u
+
+/* xorshift32, set to RANDOM_SEED to repeat a sequence */
+static uint32_t random_state = RANDOM_SEED;
+
+static uint32_t next_random(void) {
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return random_state;
+}
+
+#endif